@@ -0,0 +1,64 @@
+/*
+  This example code will walk you through letting the library pick the power
+  save mode for you. A fixed power save mode is a trade-off: mode 4 draws
+  about 1.6uA but gives a new reading only every 4.1 seconds, no power save at
+  all answers within a fraction of a second but draws 45uA. The power
+  controller watches how fast the light changes and moves between the two:
+  while the room stays the same it slows down step by step, and the moment
+  the light jumps it goes back to 20 readings a second. It also prints an
+  estimate of the average current drawn so far. 
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_PowerControl.h"
+
+#define AL_ADDR 0x48
+
+SparkFun_Ambient_Light_A light(AL_ADDR);
+VEML6030PowerController power(light);
+
+// The default policy; its fields can be changed before begin(), e.g. a
+// shorter calmMs to slow down sooner.
+VEML6030PowerPolicy policy;
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+  // With the cache on every change of level is a single write.
+  light.enableShadowCache();
+  light.setGain(.125);
+
+  power.begin(policy, millis());
+
+}
+
+void loop(){
+
+  if (power.poll(millis())) {
+    Serial.print("Ambient Light Reading: ");
+    Serial.print(power.milliLux() / 1000.0, 3);
+    Serial.print(" Lux, level: ");
+    Serial.print(power.level());
+    Serial.print(", average current: ");
+    Serial.print(power.averageCurrentUA(millis()), 1);
+    Serial.println(" uA");
+  }
+
+}
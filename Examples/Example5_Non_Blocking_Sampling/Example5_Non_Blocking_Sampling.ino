@@ -0,0 +1,66 @@
+/*
+  This example code will walk you through reading the Ambient Light Sensor
+  without ever blocking your sketch. Instead of calling delay() and hoping the
+  sensor has finished a new reading, the library works out when the next
+  sample is due from the integration time and power save mode. Your loop just
+  calls poll() with the current time and picks the sample up when it is ready,
+  leaving the rest of the time free for other work. 
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+#define AL_ADDR 0x48
+
+SparkFun_Ambient_Light_A light(AL_ADDR);
+
+// Possible values: .125, .25, 1, 2
+float gain = .125;
+
+// Possible integration times in milliseconds: 800, 400, 200, 100, 50, 25
+int time = 200;
+
+unsigned long loops = 0; 
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+  light.setGain(gain);
+  light.setIntegTime(time);
+
+  // Start the first measurement. From here on the sensor keeps sampling on
+  // its own and poll() tells us when a new value exists. 
+  light.startMeasurement(millis());
+
+}
+
+void loop(){
+
+  if (light.poll(millis())) {
+    Serial.print("Ambient Light Reading: ");
+    Serial.print(light.takeSample());
+    Serial.print(" Lux, loops since last reading: ");
+    Serial.println(loops);
+    loops = 0; 
+  }
+
+  // Anything else your sketch needs to do goes here.
+  loops++; 
+
+}
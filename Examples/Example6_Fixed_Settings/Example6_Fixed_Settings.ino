@@ -0,0 +1,79 @@
+/*
+  This example code compares the VEML6030Fixed class with the regular
+  SparkFun_Ambient_Light_A class. If your project never changes the gain or
+  integration time after start up, VEML6030Fixed takes them as template
+  parameters so every conversion value is worked out by the compiler. A light
+  reading is then a single I2C read and a multiplication by a constant. 
+
+  To compare the cost of the two classes on your board: 
+  * Speed - upload the sketch once with USE_FIXED set to 1 and once with it
+    set to 0 and compare the time per reading printed to the serial monitor.
+  * Size - compare the "Sketch uses ... bytes" and "Global variables use ..."
+    lines the Arduino IDE prints after verifying each version. 
+  extras/size_report and extras/host/fixed_benchmark.cpp in the library
+  make the same comparison without a board.
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Fixed.h"
+
+#define AL_ADDR 0x48
+
+// 1 for the compile time class, 0 for the regular one.
+#define USE_FIXED 1
+
+#if USE_FIXED
+VEML6030Fixed<VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms100> light(AL_ADDR);
+#else
+SparkFun_Ambient_Light_A light(AL_ADDR);
+#endif
+
+// Number of readings timed per line of output.
+const int reads = 100; 
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+#if !USE_FIXED
+  // The regular class needs its settings at run time.
+  light.setGain(.125);
+  light.setIntegTime(100);
+#endif
+
+}
+
+void loop(){
+
+  uint32_t luxVal = 0; 
+  unsigned long start = micros(); 
+
+  for (int i = 0; i < reads; i++)
+    luxVal = light.readLight_A(); 
+
+  unsigned long elapsed = micros() - start; 
+
+  Serial.print("Ambient Light Reading: ");
+  Serial.print(luxVal);
+  Serial.print(" Lux, ");
+  Serial.print(elapsed / reads);
+  Serial.println(" microseconds per reading");  
+  delay(1000);
+
+}
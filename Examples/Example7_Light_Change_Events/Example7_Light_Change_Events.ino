@@ -0,0 +1,79 @@
+/*
+  This example code will walk you through event mode. Instead of reading the
+  sensor over and over, the sensor's interrupt thresholds are kept in a window
+  around the last reading. Nothing happens on the I2C bus until the light
+  moves out of that window; then the INT pin fires, the library reads the new
+  value, moves the window to it and calls your function. This example does
+  require the interrupt pin on the product to be connected to an interrupt
+  capable pin on your micro-controller. 
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+#define AL_ADDR 0x48
+
+SparkFun_Ambient_Light_A light(AL_ADDR);
+
+// Possible values: .125, .25, 1, 2
+float gain = .125;
+
+// Possible integration times in milliseconds: 800, 400, 200, 100, 50, 25
+int time = 100;
+
+// Report a change once the light moves by more than 10 percent.
+int band = 10; 
+
+// Interrupt pin, the sensor pulls it low. 
+int intPin = 3; 
+
+// Runs in interrupt context: only let the library know.
+void lightInterrupt(){
+  light.notifyInterrupt(); 
+}
+
+// Called from serviceEvents() in loop(), so printing is fine here.
+void lightChanged(uint32_t luxVal, uint8_t direction){
+  Serial.print("Light went ");
+  Serial.print(direction == VEML6030::INT_ABOVE ? "up" : "down");
+  Serial.print(" to ");
+  Serial.print(luxVal);
+  Serial.println(" Lux");
+}
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+  pinMode(intPin, INPUT_PULLUP);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+  // The window is kept in raw counts, so set gain and time first.
+  light.setGain(gain);
+  light.setIntegTime(time);
+  delay(time + 10); // Let the first reading finish.
+
+  light.onLightChange(lightChanged); 
+  light.enableEventMode(band, true); 
+  attachInterrupt(digitalPinToInterrupt(intPin), lightInterrupt, FALLING);
+
+}
+
+void loop(){
+
+  light.serviceEvents(); 
+
+}
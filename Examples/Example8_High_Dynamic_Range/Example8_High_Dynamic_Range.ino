@@ -0,0 +1,61 @@
+/*
+  This example code will walk you through reading the Ambient Light Sensor in
+  high dynamic range mode. One gain and integration time can either resolve
+  very dim light or reach full sunlight, not both. Here the sensor switches
+  back and forth between a fine setting (gain 2, 100ms: .0288 lux per count)
+  and a coarse one (gain 1/8, 25ms: up to 120000 lux), and each new reading is
+  blended with the last one of the other setting. In the dark the fine setting
+  does nearly all the work; once it saturates the coarse one takes over. 
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_HDR.h"
+
+#define AL_ADDR 0x48
+
+SparkFun_Ambient_Light_A light(AL_ADDR);
+VEML6030HDR hdr(light);
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+  // With the cache on every switch between the settings is a single write.
+  light.enableShadowCache();
+
+  // Each switch waits for both integration times, so no reading can come
+  // from the old setting: a new value every 127ms. See the top of
+  // SparkFun_VEML6030_HDR.h for the build flag that waits only the new one.
+  hdr.begin(VEML6030::Gain::X2, VEML6030::IntegTime::Ms100,
+            VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms25, millis());
+
+}
+
+void loop(){
+
+  if (hdr.poll(millis())) {
+    Serial.print("Ambient Light Reading: ");
+    Serial.print(hdr.milliLux() / 1000.0, 3);
+    Serial.print(" Lux, resolution: ");
+    Serial.print(hdr.resolutionMilliLux() / 1000.0, 4);
+    Serial.print(" Lux, fine setting weight: ");
+    Serial.println(hdr.firstWeight());
+  }
+
+}
@@ -0,0 +1,89 @@
+/*
+  This example code will walk you through sending the Ambient Light Sensor's
+  readings over a slow link, e.g. a radio, in as few bytes as possible. The
+  sensor is read every 100ms, but a reading is only kept when the light has
+  changed by more than 1 lux or 5%, or at least once a minute. Kept readings
+  are packed into 32 byte blocks, about two bytes each while the light is
+  steady. Each full block is printed in hex, then unpacked again to show what
+  the receiving end gets. 
+
+  SparkFun Electronics
+  Date: July 2019
+
+	License: This code is public domain but if you use this and we meet someday, get me a beer! 
+
+	Feel like supporting our work? Buy a board from Sparkfun!
+	https://www.sparkfun.com/products/15436
+
+*/
+
+#include <Wire.h>
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Stream.h"
+
+#define AL_ADDR 0x48
+
+SparkFun_Ambient_Light_A light(AL_ADDR);
+
+// 1 lux or 5% of the last kept value, and at least one value per minute.
+VEML6030ChangeFilter filter(1000, 50, 60000);
+
+uint8_t block[32];
+VEML6030StreamEncoder encoder(block, sizeof(block));
+
+// Possible values: .125, .25, 1, 2
+float gain = .125;
+// Possible values: 800, 400, 200, 100, 50, 25
+int timeVal = 100;
+
+void sendBlock(){
+  Serial.print("Block of ");
+  Serial.print(encoder.count());
+  Serial.print(" readings in ");
+  Serial.print(encoder.size());
+  Serial.print(" bytes: ");
+  for (uint16_t i = 0; i < encoder.size(); i++) {
+    if (encoder.data()[i] < 0x10)
+      Serial.print("0");
+    Serial.print(encoder.data()[i], HEX);
+  }
+  Serial.println();
+
+  // What the receiving end does with the block.
+  VEML6030StreamDecoder decoder(encoder.data(), encoder.size());
+  VEML6030RawSample sample;
+  while (decoder.next(sample)) {
+    Serial.print("  ");
+    Serial.print(sample.timestamp);
+    Serial.print(" ms: ");
+    Serial.print(sample.milliLux() / 1000.0, 3);
+    Serial.println(" Lux");
+  }
+}
+
+void setup(){
+
+  Wire.begin();
+  Serial.begin(115200);
+
+  if(light.begin())
+    Serial.println("Ready to sense some light!"); 
+  else
+    Serial.println("Could not communicate with the sensor!");
+
+  light.setGain(gain);
+  light.setIntegTime(timeVal);
+
+}
+
+void loop(){
+
+  if (filter.update(light, millis()) && !encoder.add(filter.last())) {
+    // The block is full, or the gain or integration time changed.
+    sendBlock();
+    encoder.reset();
+    encoder.add(filter.last());
+  }
+  delay(100);
+
+}
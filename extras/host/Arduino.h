@@ -0,0 +1,28 @@
+/*
+  Host stand-in for the parts of Arduino.h used by the library, so it can be
+  built and exercised on Linux against the simulated sensor in VEML6030Sim.h.
+  Time is simulated: it only moves when delay() is called, when the simulated
+  bus spends time on a transfer, or when a program calls simAdvanceMicros().
+ */
+
+#ifndef _VEML6030_HOST_ARDUINO_H_
+#define _VEML6030_HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Simulated time since start up.
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Moves simulated time forward, e.g. to model other work done by a sketch.
+void simAdvanceMicros(uint64_t us);
+
+// Simulated time with the full 64 bits, for programs that run long enough to
+// wrap micros().
+uint64_t simMicros64();
+
+#endif
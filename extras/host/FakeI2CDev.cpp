@@ -0,0 +1,93 @@
+/*
+  A fake Linux i2c-dev adapter for host builds, see FakeI2CDev.h.
+ */
+
+#include "FakeI2CDev.h"
+#include <errno.h>
+#include <string.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+FakeI2CDev::FakeI2CDev(const char *path) : _path(path), _clockHz(400000), _openCount(0)
+{
+  memset(_devices, 0, sizeof(_devices));
+  resetStats();
+}
+
+void FakeI2CDev::attach(uint8_t address, SimI2CDevice *device)
+{
+  if (address < 128)
+    _devices[address] = device;
+}
+
+void FakeI2CDev::resetStats()
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+int FakeI2CDev::open(const char *path)
+{
+  _stats.syscalls++;
+  if (strcmp(path, _path) != 0) {
+    errno = ENOENT;
+    return -1;
+  }
+  _openCount++;
+  return FAKE_FD;
+}
+
+int FakeI2CDev::close(int fd)
+{
+  _stats.syscalls++;
+  if (fd != FAKE_FD || _openCount == 0) {
+    errno = EBADF;
+    return -1;
+  }
+  _openCount--;
+  return 0;
+}
+
+// Every byte, the address included, takes nine clocks. Each message starts with
+// a START or repeated START, the transfer ends with a STOP.
+int FakeI2CDev::rdwr(int fd, struct i2c_rdwr_ioctl_data *data)
+{
+  _stats.syscalls++;
+  _stats.ioctls++;
+  if (fd != FAKE_FD || _openCount == 0) {
+    errno = EBADF;
+    return -1;
+  }
+  if (data->nmsgs > I2C_RDWR_IOCTL_MAX_MSGS) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  uint32_t clocks = 1;
+  int result = (int)data->nmsgs;
+  for (uint32_t i = 0; i < data->nmsgs; i++) {
+    const struct i2c_msg &msg = data->msgs[i];
+    SimI2CDevice *device = (msg.addr < 128) ? _devices[msg.addr] : NULL;
+    _stats.messages++;
+    clocks += 1 + 9 * (1 + msg.len);
+
+    bool acked;
+    if (!device)
+      acked = false;
+    else if (msg.flags & I2C_M_RD)
+      acked = device->i2cRead(msg.buf, msg.len);
+    else
+      acked = (msg.len == 0) || device->i2cWrite(msg.buf, msg.len);
+
+    if (!acked) {
+      _stats.nacks++;
+      errno = ENXIO;
+      result = -1;
+      break;
+    }
+  }
+
+  uint64_t us = ((uint64_t)clocks * 1000000 + _clockHz - 1) / _clockHz;
+  _stats.busTimeUs += us;
+  simAdvanceMicros(us);
+  return result;
+}
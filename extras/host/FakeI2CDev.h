@@ -0,0 +1,57 @@
+/*
+  A fake Linux i2c-dev adapter for host builds. It stands in for the system
+  calls of VEML6030LinuxI2C (see VEML6030I2CDevOps) and delivers each I2C_RDWR
+  message to the simulated devices attached to it, so the Linux backend runs
+  against VEML6030Sim without hardware. It counts system calls and messages
+  and moves the simulated clock by the time the transfers would take on the
+  bus. Like the kernel, a NACK ends the transfer with ENXIO and a transfer of
+  more than I2C_RDWR_IOCTL_MAX_MSGS messages is refused with EINVAL.
+ */
+
+#ifndef _VEML6030_FAKE_I2C_DEV_H_
+#define _VEML6030_FAKE_I2C_DEV_H_
+
+#include "SparkFun_VEML6030_LinuxI2C.h"
+#include "Wire.h"
+
+struct FakeI2CDevStats
+{
+  uint32_t syscalls;    // open, close and ioctl calls
+  uint32_t ioctls;
+  uint32_t messages;
+  uint32_t nacks;
+  uint64_t busTimeUs;
+};
+
+class FakeI2CDev : public VEML6030I2CDevOps
+{
+  public:
+
+    // The adapter answers open() for this path only.
+    FakeI2CDev(const char *path = "/dev/i2c-1");
+
+    void setClock(uint32_t hz) { _clockHz = hz; }
+
+    // Connects a simulated device at a 7-bit address, as TwoWire::attach().
+    void attach(uint8_t address, SimI2CDevice *device);
+
+    const FakeI2CDevStats &stats() const { return _stats; }
+    void resetStats();
+
+    // VEML6030I2CDevOps
+    int open(const char *path);
+    int close(int fd);
+    int rdwr(int fd, struct i2c_rdwr_ioctl_data *data);
+
+  private:
+
+    static const int FAKE_FD = 100;
+
+    SimI2CDevice *_devices[128];
+    const char *_path;
+    uint32_t _clockHz;
+    int _openCount;
+    FakeI2CDevStats _stats;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+  A simulated VEML6030 for host builds, see VEML6030Sim.h.
+ */
+
+#include "VEML6030Sim.h"
+#include <string.h>
+
+// Register addresses and bits, as in the datasheet.
+static const uint8_t SIM_SETTING_REG = 0x00;
+static const uint8_t SIM_H_THRESH_REG = 0x01;
+static const uint8_t SIM_L_THRESH_REG = 0x02;
+static const uint8_t SIM_POWER_SAVE_REG = 0x03;
+static const uint8_t SIM_ALS_REG = 0x04;
+static const uint8_t SIM_WHITE_REG = 0x05;
+static const uint8_t SIM_INTERRUPT_REG = 0x06;
+
+static const uint16_t SIM_SD = 0x0001;
+static const uint16_t SIM_INT_EN = 0x0002;
+static const uint16_t SIM_PSM_EN = 0x0001;
+static const uint16_t SIM_INT_TH_HIGH = 0x4000;
+static const uint16_t SIM_INT_TH_LOW = 0x8000;
+
+VEML6030Sim::VEML6030Sim() : _pointer(0), _whiteRatio(1.25), _nextConversionUs(0),
+                             _highCount(0), _lowCount(0), _freshSample(false), _failures(0)
+{
+  memset(_regs, 0, sizeof(_regs));
+  _regs[SIM_SETTING_REG] = SIM_SD; // Shut down at power up
+  setLux(0);
+  resetStats();
+}
+
+void VEML6030Sim::setLux(double lux)
+{
+  _scene = [lux](uint64_t) { return lux; };
+}
+
+void VEML6030Sim::setScene(const Scene &scene)
+{
+  _scene = scene;
+}
+
+void VEML6030Sim::resetStats()
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+uint16_t VEML6030Sim::reg(uint8_t address)
+{
+  _update();
+  return (address < 7) ? _regs[address] : 0;
+}
+
+void VEML6030Sim::setReg(uint8_t address, uint16_t value)
+{
+  _update();
+  if (address < 7)
+    _regs[address] = value;
+  if (address == SIM_SETTING_REG || address == SIM_POWER_SAVE_REG)
+    _restartCycle();
+}
+
+uint64_t VEML6030Sim::nextConversionUs()
+{
+  _update();
+  return _nextConversionUs;
+}
+
+uint32_t VEML6030Sim::integTimeUs(uint16_t settingReg)
+{
+  switch ((settingReg >> 6) & 0x0F) {
+    case 0:  return 100000;
+    case 1:  return 200000;
+    case 2:  return 400000;
+    case 3:  return 800000;
+    case 8:  return 50000;
+    case 12: return 25000;
+    default: return 0;
+  }
+}
+
+double VEML6030Sim::luxPerCount(uint16_t settingReg)
+{
+  uint32_t it = integTimeUs(settingReg);
+  if (!it)
+    return 0;
+
+  // .0036 lux per count at gain 2 and 800ms, scaled by gain and time.
+  static const double gainFactor[] = {2, 1, 16, 8}; // Bits 00: x1, 01: x2, 10: x1/8, 11: x1/4
+  return .0036 * gainFactor[(settingReg >> 11) & 0x03] * (800000.0 / it);
+}
+
+// One cycle is the integration time, plus the wait time of the power save mode
+// (500, 1000, 2000 or 4000ms) when it is enabled.
+uint64_t VEML6030Sim::_periodUs()
+{
+  uint64_t period = integTimeUs(_regs[SIM_SETTING_REG]);
+  uint16_t psm = _regs[SIM_POWER_SAVE_REG];
+  if (psm & SIM_PSM_EN)
+    period += 500000ULL << ((psm >> 1) & 0x03);
+  return period;
+}
+
+// Any configuration write starts a new integration.
+void VEML6030Sim::_restartCycle()
+{
+  uint32_t it = integTimeUs(_regs[SIM_SETTING_REG]);
+  if ((_regs[SIM_SETTING_REG] & SIM_SD) || !it)
+    _nextConversionUs = 0;
+  else
+    _nextConversionUs = simMicros64() + it;
+  _highCount = 0;
+  _lowCount = 0;
+}
+
+void VEML6030Sim::_update()
+{
+  uint64_t now = simMicros64();
+  while (_nextConversionUs && _nextConversionUs <= now) {
+    _convert(_nextConversionUs);
+    _nextConversionUs += _periodUs();
+  }
+}
+
+void VEML6030Sim::_convert(uint64_t atUs)
+{
+  double conv = luxPerCount(_regs[SIM_SETTING_REG]);
+  double lux = _scene(atUs);
+  double counts = (lux > 0) ? lux / conv + .5 : 0;
+  double white = counts * _whiteRatio;
+
+  _regs[SIM_ALS_REG] = (counts > 65535) ? 65535 : (uint16_t)counts;
+  _regs[SIM_WHITE_REG] = (white > 65535) ? 65535 : (uint16_t)white;
+  _stats.conversions++;
+  _freshSample = true;
+
+  uint16_t setting = _regs[SIM_SETTING_REG];
+  if (!(setting & SIM_INT_EN))
+    return;
+
+  // Persistence protect: 1, 2, 4 or 8 consecutive values beyond a threshold.
+  uint8_t persistence = 1 << ((setting >> 4) & 0x03);
+  uint16_t als = _regs[SIM_ALS_REG];
+
+  _highCount = (als > _regs[SIM_H_THRESH_REG]) ? _highCount + 1 : 0;
+  _lowCount = (als < _regs[SIM_L_THRESH_REG]) ? _lowCount + 1 : 0;
+  if (_highCount >= persistence) {
+    _regs[SIM_INTERRUPT_REG] |= SIM_INT_TH_HIGH;
+    _highCount = persistence;
+  }
+  if (_lowCount >= persistence) {
+    _regs[SIM_INTERRUPT_REG] |= SIM_INT_TH_LOW;
+    _lowCount = persistence;
+  }
+}
+
+// A write is the command code alone (setting the register pointer for a
+// following read) or the command code followed by LSB and MSB.
+bool VEML6030Sim::i2cWrite(const uint8_t *data, size_t len)
+{
+  if (_failures) {
+    _failures--;
+    return false;
+  }
+
+  _update();
+  if (data[0] > SIM_INTERRUPT_REG)
+    return false;
+
+  _pointer = data[0];
+  if (len < 3)
+    return true;
+
+  // Only 0x00 - 0x03 are writable.
+  if (_pointer > SIM_POWER_SAVE_REG)
+    return false;
+
+  _regs[_pointer] = data[1] | (data[2] << 8);
+  _stats.registerWrites++;
+  if (_pointer == SIM_SETTING_REG || _pointer == SIM_POWER_SAVE_REG)
+    _restartCycle();
+  return true;
+}
+
+// Reads return the register last pointed at, LSB first.
+bool VEML6030Sim::i2cRead(uint8_t *data, size_t len)
+{
+  if (_failures) {
+    _failures--;
+    return false;
+  }
+
+  _update();
+  uint16_t value = _regs[_pointer];
+  for (size_t i = 0; i < len; i++)
+    data[i] = (i == 0) ? (value & 0xFF) : (i == 1) ? (value >> 8) : 0xFF;
+
+  _stats.registerReads++;
+  if (_pointer == SIM_ALS_REG) {
+    if (!_freshSample)
+      _stats.staleReads++;
+    _freshSample = false;
+  }
+  if (_pointer == SIM_INTERRUPT_REG)
+    _regs[SIM_INTERRUPT_REG] = 0;
+  return true;
+}
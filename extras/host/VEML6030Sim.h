@@ -0,0 +1,88 @@
+/*
+  A simulated VEML6030 for host builds. It answers on the simulated bus in
+  Wire.h with the register file of the real part (0x00 - 0x06) and models:
+  * conversions: a new ALS/WHITE value at the end of every integration time,
+    followed by the power save mode wait time if PSM is enabled
+  * shut down: no conversions while SD is set, the last values are kept
+  * interrupts: the high/low flags of REG0x06 with persistence protect, set
+    only while INT_EN is set and cleared when REG0x06 is read
+  * light scenes: a constant light level or a function of simulated time
+ */
+
+#ifndef _VEML6030_SIM_H_
+#define _VEML6030_SIM_H_
+
+#include "Wire.h"
+#include <functional>
+
+class VEML6030Sim : public SimI2CDevice
+{
+  public:
+
+    // Light in lux as a function of simulated time in microseconds.
+    typedef std::function<double(uint64_t)> Scene;
+
+    struct Stats
+    {
+      uint32_t conversions;     // Completed ALS conversions
+      uint32_t registerReads;
+      uint32_t registerWrites;
+      uint32_t staleReads;      // ALS reads with no new conversion since the last one
+    };
+
+    VEML6030Sim();
+
+    // These functions set the light the sensor sees. The value is linear lux,
+    // i.e. what readLight_A() reports before compensation. 
+    void setLux(double lux);
+    void setScene(const Scene &scene);
+
+    // WHITE channel counts relative to the ALS counts.
+    void setWhiteRatio(double ratio) { _whiteRatio = ratio; }
+
+    // Makes the next count register accesses NACK, to exercise error handling.
+    void failNext(uint32_t count) { _failures = count; }
+
+    // Direct access to the register file, bypassing the bus. 
+    uint16_t reg(uint8_t address);
+    void setReg(uint8_t address, uint16_t value);
+
+    // Simulated time at which the next conversion completes, or 0 while shut
+    // down.
+    uint64_t nextConversionUs();
+
+    const Stats &stats() const { return _stats; }
+    void resetStats();
+
+    // Integration time and lux per count of a SETTING_REG value, from the
+    // datasheet. Integration time is 0 for reserved bit patterns.
+    static uint32_t integTimeUs(uint16_t settingReg);
+    static double luxPerCount(uint16_t settingReg);
+
+    // SimI2CDevice
+    bool i2cWrite(const uint8_t *data, size_t len);
+    bool i2cRead(uint8_t *data, size_t len);
+
+  private:
+
+    void _update();
+    void _convert(uint64_t atUs);
+    void _restartCycle();
+    uint64_t _periodUs();
+
+    uint16_t _regs[7];
+    uint8_t _pointer;
+
+    Scene _scene;
+    double _whiteRatio;
+
+    uint64_t _nextConversionUs;
+    uint8_t _highCount;
+    uint8_t _lowCount;
+    bool _freshSample;
+    uint32_t _failures;
+
+    Stats _stats;
+};
+
+#endif
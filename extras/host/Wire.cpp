@@ -0,0 +1,138 @@
+/*
+  Host stand-in for the Arduino TwoWire class and the simulated clock, see
+  Arduino.h and Wire.h.
+ */
+
+#include "Wire.h"
+#include <string.h>
+
+static uint64_t simTimeUs = 0;
+
+unsigned long micros() { return (unsigned long)simTimeUs; }
+unsigned long millis() { return (unsigned long)(simTimeUs / 1000); }
+void delay(unsigned long ms) { simTimeUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned int us) { simTimeUs += us; }
+void simAdvanceMicros(uint64_t us) { simTimeUs += us; }
+uint64_t simMicros64() { return simTimeUs; }
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : _clockHz(100000), _txLength(0), _rxLength(0), _rxIndex(0)
+{
+  memset(_devices, 0, sizeof(_devices));
+  resetStats();
+}
+
+void TwoWire::attach(uint8_t address, SimI2CDevice *device)
+{
+  for (uint8_t i = 0; i < MAX_DEVICES; i++) {
+    if (_devices[i] && _addresses[i] == address) {
+      _devices[i] = device;
+      return;
+    }
+  }
+  for (uint8_t i = 0; i < MAX_DEVICES && device; i++) {
+    if (!_devices[i]) {
+      _addresses[i] = address;
+      _devices[i] = device;
+      return;
+    }
+  }
+}
+
+void TwoWire::resetStats()
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+SimI2CDevice *TwoWire::_find(uint8_t address)
+{
+  for (uint8_t i = 0; i < MAX_DEVICES; i++)
+    if (_devices[i] && _addresses[i] == address)
+      return _devices[i];
+  return NULL;
+}
+
+// Every byte takes nine clocks (eight data bits and the acknowledge). A START
+// or repeated START and a STOP take about one clock each.
+void TwoWire::_spend(uint32_t bytes, bool stop)
+{
+  uint32_t clocks = bytes * 9 + 1 + (stop ? 1 : 0);
+  uint64_t us = ((uint64_t)clocks * 1000000 + _clockHz - 1) / _clockHz;
+  _stats.busTimeUs += us;
+  simAdvanceMicros(us);
+
+  if (stop)
+    _stats.transactions++;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  _txAddress = address;
+  _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+  if (_txLength >= BUFFER_LENGTH)
+    return 0;
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+// Returns 0 on success and 2 for an address NACK, like the AVR core.
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  SimI2CDevice *device = _find(_txAddress);
+
+  _stats.bytesWritten += 1 + _txLength;
+  if (!device) {
+    // Only the address goes out before the NACK.
+    _stats.bytesWritten -= _txLength;
+    _stats.nacks++;
+    _spend(1, true);
+    return 2;
+  }
+
+  bool ack = (_txLength == 0) || device->i2cWrite(_txBuffer, _txLength);
+  _spend(1 + _txLength, sendStop || !ack);
+  if (!ack) {
+    _stats.nacks++;
+    return 3;
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop)
+{
+  SimI2CDevice *device = _find(address);
+
+  _rxLength = 0;
+  _rxIndex = 0;
+  if (quantity > BUFFER_LENGTH)
+    quantity = BUFFER_LENGTH;
+
+  _stats.bytesWritten++;
+  if (!device || !device->i2cRead(_rxBuffer, quantity)) {
+    _stats.nacks++;
+    _spend(1, true);
+    return 0;
+  }
+
+  _stats.bytesRead += quantity;
+  _spend(1 + quantity, sendStop);
+  _rxLength = quantity;
+  return quantity;
+}
+
+int TwoWire::available()
+{
+  return _rxLength - _rxIndex;
+}
+
+int TwoWire::read()
+{
+  if (_rxIndex >= _rxLength)
+    return -1;
+  return _rxBuffer[_rxIndex++];
+}
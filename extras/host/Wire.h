@@ -0,0 +1,85 @@
+/*
+  Host stand-in for the Arduino TwoWire class. Transfers go to simulated
+  devices attached with attach() instead of real hardware, and every transfer
+  is accounted for in a TwoWireStats: transactions, bytes each way and the time
+  the bus would have been busy at the configured clock. The simulated clock in
+  Arduino.h is moved forward by that time.
+ */
+
+#ifndef _VEML6030_HOST_WIRE_H_
+#define _VEML6030_HOST_WIRE_H_
+
+#include "Arduino.h"
+
+// A device on the simulated bus. Write transfers deliver every byte after the
+// address; read transfers ask for the number of bytes requested. Returning
+// false from either makes the device NACK.
+class SimI2CDevice
+{
+  public:
+    virtual ~SimI2CDevice() {}
+    virtual bool i2cWrite(const uint8_t *data, size_t len) = 0;
+    virtual bool i2cRead(uint8_t *data, size_t len) = 0;
+};
+
+// Bus traffic since the last reset. A transaction runs from a START to a STOP,
+// so a register read made of a write, a repeated START and a read counts once.
+struct TwoWireStats
+{
+  uint32_t transactions;
+  uint32_t bytesWritten;   // Including address bytes
+  uint32_t bytesRead;
+  uint32_t nacks;
+  uint64_t busTimeUs;
+};
+
+class TwoWire
+{
+  public:
+
+    TwoWire();
+
+    void begin() {}
+    void setClock(uint32_t hz) { _clockHz = hz; }
+
+    // Connects a simulated device at a 7-bit address. A second device at the
+    // same address replaces the first; NULL removes it.
+    void attach(uint8_t address, SimI2CDevice *device);
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+    int available();
+    int read();
+
+    const TwoWireStats &stats() const { return _stats; }
+    void resetStats();
+
+  private:
+
+    static const uint8_t MAX_DEVICES = 8;
+    static const uint8_t BUFFER_LENGTH = 32;
+
+    SimI2CDevice *_find(uint8_t address);
+    void _spend(uint32_t bytes, bool stop);
+
+    uint8_t _addresses[MAX_DEVICES];
+    SimI2CDevice *_devices[MAX_DEVICES];
+
+    uint32_t _clockHz;
+
+    uint8_t _txAddress;
+    uint8_t _txBuffer[BUFFER_LENGTH];
+    uint8_t _txLength;
+
+    uint8_t _rxBuffer[BUFFER_LENGTH];
+    uint8_t _rxLength;
+    uint8_t _rxIndex;
+
+    TwoWireStats _stats;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,143 @@
+/*
+  Check of VEML6030Array on the simulated bus.
+
+  Four sensors, two addresses on each of two ports, at 100ms without power
+  save, each in a different light.
+  1. Interleaving: every frame holds each sensor's own light, read from a new
+     conversion, and the sensors are read in the order they were added, each
+     in a different millisecond, within one refresh period.
+  2. Stagger: each sensor is read a quarter of the refresh period after the
+     one before it, give or take a millisecond of polling.
+  3. Status: a sensor that cannot be shut down makes start() report
+     VEML6030_BUS_ERROR for it alone, and a power up that fails in poll() is
+     reported by status() and retried until the frames come again.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp extras/host/Wire.cpp \
+        extras/host/VEML6030Sim.cpp extras/host/array_check.cpp -o array_check
+    ./array_check
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Array.h"
+#include "VEML6030Sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const uint8_t SENSORS = 4;
+static const uint32_t PERIOD_MS = 100;
+static const uint32_t SLOT_MS = PERIOD_MS / SENSORS;
+
+static uint32_t failures = 0;
+static void expect(bool ok, const char *what)
+{
+  if (!ok) {
+    failures++;
+    if (failures <= 10)
+      printf("  FAILED: %s\n", what);
+  }
+}
+
+static TwoWire wire2;
+static VEML6030Sim sims[SENSORS];
+static SparkFun_Ambient_Light_A light0(0x48), light1(0x10), light2(0x48), light3(0x10);
+static SparkFun_Ambient_Light_A *lights[SENSORS] = { &light0, &light1, &light2, &light3 };
+static const uint32_t luxSet[SENSORS] = { 100, 200, 300, 400 };
+
+// Polls the array every millisecond for runMs and checks every frame after the
+// first, the order and stagger of the reads only if asked to. Returns the number of frames checked.
+static uint32_t run(VEML6030Array<SENSORS> &array, uint32_t runMs, bool stagger)
+{
+  uint32_t checked = 0;
+  uint32_t lastSequence = array.frame().sequence;
+  uint32_t start = millis();
+  bool first = true;
+
+  while (millis() - start < runMs) {
+    if (array.poll(millis())) {
+      const VEML6030Array<SENSORS>::Frame &frame = array.frame();
+      expect(frame.sequence == lastSequence + 1, "frame sequence");
+      lastSequence = frame.sequence;
+      if (first) {
+        first = false; // May hold a sensor retried out of its slot.
+      }
+      else {
+        checked++;
+        for (uint8_t i = 0; i < SENSORS; i++)
+          expect(abs((int32_t)frame.lux[i] - (int32_t)luxSet[i]) <= 1, "each sensor's own light");
+        for (uint8_t i = 1; stagger && i < SENSORS; i++) {
+          int32_t gap = frame.timestamp[i] - frame.timestamp[i - 1];
+          expect(gap > 0, "sensors read in order, in different milliseconds");
+          expect(abs(gap - (int32_t)SLOT_MS) <= 1, "reads a quarter period apart");
+        }
+        expect(frame.skew < PERIOD_MS, "skew below one refresh period");
+      }
+    }
+    delay(1);
+  }
+  return checked;
+}
+
+int main()
+{
+  Wire.attach(0x48, &sims[0]);
+  Wire.attach(0x10, &sims[1]);
+  wire2.attach(0x48, &sims[2]);
+  wire2.attach(0x10, &sims[3]);
+
+  VEML6030Array<SENSORS> array;
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    sims[i].setLux(luxSet[i]);
+    lights[i]->begin(i < 2 ? Wire : wire2);
+    lights[i]->setGain(.125);
+    lights[i]->setIntegTime(PERIOD_MS);
+    lights[i]->enableShadowCache(); // One bus write per shut down and power up.
+    array.add(*lights[i]);
+  }
+
+  // 1. and 2. Interleaving and stagger.
+  for (uint8_t i = 0; i < SENSORS; i++)
+    sims[i].resetStats();
+  expect(array.start(millis()) == VEML6030_OK, "start() reports success");
+  uint32_t frames = run(array, 3000, true);
+  uint32_t stale = 0;
+  for (uint8_t i = 0; i < SENSORS; i++)
+    stale += sims[i].stats().staleReads;
+  expect(frames >= 3000 / PERIOD_MS - 3, "one frame per refresh period");
+  expect(stale == 0, "no conversion read twice");
+  printf("Interleaving:     %u frames in 3s checked, %u stale reads\n", (unsigned)frames, (unsigned)stale);
+  printf("Stagger:          read at +0, +%d, +%d, +%d ms in the last frame\n",
+         (int)(array.frame().timestamp[1] - array.frame().timestamp[0]),
+         (int)(array.frame().timestamp[2] - array.frame().timestamp[0]),
+         (int)(array.frame().timestamp[3] - array.frame().timestamp[0]));
+
+  // 3. A shut down that fails, then a power up that fails. The sensor that
+  // kept running waits for the conversion it was in before its first sample,
+  // so it is read out of its slot until the next start().
+  sims[2].failNext(1);
+  expect(array.start(millis()) == VEML6030_BUS_ERROR, "start() reports a failed shut down");
+  expect(array.status(0) == VEML6030_OK && array.status(1) == VEML6030_OK &&
+         array.status(2) == VEML6030_BUS_ERROR && array.status(3) == VEML6030_OK,
+         "status() names the sensor that failed");
+  frames = run(array, 1000, false);
+  expect(frames >= 1000 / PERIOD_MS - 3 && array.status(2) == VEML6030_OK, "sampling goes on after it");
+
+  expect(array.start(millis()) == VEML6030_OK, "start() after a failure");
+  array.poll(millis());
+  delay(SLOT_MS - 1);
+  array.poll(millis());
+  sims[1].failNext(1); // The write of the power up.
+  delay(1);
+  array.poll(millis());
+  expect(array.status(1) == VEML6030_BUS_ERROR, "status() reports a failed power up");
+  frames = run(array, 2000, true);
+  expect(array.status(1) == VEML6030_OK, "poll() retries the power up");
+  expect(frames >= 2000 / PERIOD_MS - 3, "frames come again after the retry");
+  printf("Status:           failed shut down and power up reported, %u frames after the retry\n",
+         (unsigned)frames);
+
+  printf("\n%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
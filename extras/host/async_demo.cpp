@@ -0,0 +1,155 @@
+/*
+  Drives 256 simulated sensors from one thread with VEML6030Async and
+  VEML6030Executor. The sensors sit on four fake Linux I2C adapters and run
+  at every integration time, a quarter of them in power save mode. Each
+  sensor's coroutine starts it from shut down, takes eight samples, switches
+  to gain 1/8 and takes eight more.
+
+  Checked for every sample: the value matches the sensor's light and it is a
+  new conversion taken with the current settings (the simulated sensor counts
+  stale reads). Starting 256 sensors keeps the bus busy for a while, so the
+  first samples of the later ones are read late; they still must not repeat. Printed: the simulated time all of it
+  took against reading the sensors one after the other with blocking calls,
+  and the bus and host cost per sample.
+
+  Needs C++20. Build and run from the repository root:
+
+    g++ -std=gnu++20 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_LinuxI2C.cpp \
+        src/SparkFun_VEML6030_Async.cpp extras/host/Wire.cpp extras/host/VEML6030Sim.cpp \
+        extras/host/FakeI2CDev.cpp extras/host/async_demo.cpp -o async_demo
+    ./async_demo
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_LinuxI2C.h"
+#include "SparkFun_VEML6030_Async.h"
+#include "VEML6030Sim.h"
+#include "FakeI2CDev.h"
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <stdio.h>
+
+#ifndef VEML6030_HAS_COROUTINES
+#error "async_demo needs C++20 coroutines, build with -std=gnu++20"
+#endif
+
+static const uint8_t ADAPTERS = 4;
+static const uint8_t PER_ADAPTER = 64;
+static const uint16_t SENSORS = ADAPTERS * PER_ADAPTER;
+static const uint8_t FIRST_ADDRESS = 0x10;
+static const uint8_t SAMPLES = 8;   // Before and after the gain change
+
+static const uint16_t INTEG_TIMES[] = { 25, 50, 100, 200, 400, 800 };
+
+static FakeI2CDev adapters[ADAPTERS] = {
+  FakeI2CDev("/dev/i2c-1"), FakeI2CDev("/dev/i2c-2"), FakeI2CDev("/dev/i2c-3"), FakeI2CDev("/dev/i2c-4")
+};
+
+struct Sensor
+{
+  VEML6030Sim sim;
+  std::unique_ptr<VEML6030LinuxI2C> transport;
+  std::unique_ptr<SparkFun_Ambient_Light_A> light;
+  std::unique_ptr<VEML6030Async> async;
+  double lux;
+  uint32_t blockingMs;    // Time the same work takes with blocking calls
+};
+
+static Sensor sensors[SENSORS];
+static uint32_t samples = 0, wrongValues = 0, failures = 0;
+
+static bool close(uint32_t got, double want, double luxPerCount)
+{
+  // Conversion floors to whole counts and readLight_A() to whole lux.
+  return fabs(got - want) <= luxPerCount + 1 + want * .001;
+}
+
+static VEML6030Task<void> sample(Sensor &s, double luxPerCount)
+{
+  for (uint8_t i = 0; i < SAMPLES; i++) {
+    uint32_t lux = co_await s.async->nextSample();
+    samples++;
+    if (s.async->lastStatus() != VEML6030_OK)
+      failures++;
+    if (!close(lux, s.lux, luxPerCount))
+      wrongValues++;
+  }
+}
+
+static VEML6030Task<void> run(Sensor &s, VEML6030Config config)
+{
+  if (co_await s.async->begin(*s.transport, config) == VEML6030_START_FAILED) {
+    failures++;
+    co_return;
+  }
+  co_await sample(s, VEML6030Sim::luxPerCount(s.sim.reg(SETTING_REG)));
+
+  VEML6030::IntegTime time = static_cast<VEML6030::IntegTime>((s.sim.reg(SETTING_REG) >> INTEG_POS) & 0xF);
+  if (co_await s.async->applyGain(VEML6030::Gain::X1_8, time) != VEML6030_OK)
+    failures++;
+  co_await sample(s, VEML6030Sim::luxPerCount(s.sim.reg(SETTING_REG)));
+}
+
+int main()
+{
+  VEML6030Executor executor;
+
+  for (uint16_t i = 0; i < SENSORS; i++) {
+    Sensor &s = sensors[i];
+    uint8_t address = FIRST_ADDRESS + i % PER_ADAPTER;
+    FakeI2CDev &adapter = adapters[i / PER_ADAPTER];
+    char path[16];
+    snprintf(path, sizeof(path), "/dev/i2c-%u", i / PER_ADAPTER + 1);
+
+    s.lux = 5 + 3.7 * i;
+    s.sim.setLux(s.lux);
+    adapter.attach(address, &s.sim);
+    s.transport.reset(new VEML6030LinuxI2C(address, adapter));
+    s.transport->open(path);
+    s.light.reset(new SparkFun_Ambient_Light_A(address));
+    s.async.reset(new VEML6030Async(*s.light, executor));
+
+    VEML6030Config config;
+    config.gain = .25;
+    config.integTime = INTEG_TIMES[i % 6];
+    config.powSavEnabled = (i % 4 == 3);
+    config.powSavMode = 1 + (i / 4) % 4;
+    s.blockingMs = VEML6030::WAKE_TIME_MS + 2 * SAMPLES * (config.integTime +
+                   (config.powSavEnabled ? (250 << config.powSavMode) : 0));
+    executor.spawn(run(s, config));
+  }
+
+  for (uint8_t a = 0; a < ADAPTERS; a++)
+    adapters[a].resetStats();
+  uint64_t startUs = simMicros64();
+  auto hostStart = std::chrono::steady_clock::now();
+
+  executor.run();
+
+  double hostNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - hostStart).count();
+  double elapsedMs = (simMicros64() - startUs) / 1000.0;
+
+  uint64_t blockingMs = 0, slowestMs = 0, ioctls = 0, stale = 0;
+  for (uint16_t i = 0; i < SENSORS; i++) {
+    blockingMs += sensors[i].blockingMs;
+    if (sensors[i].blockingMs > slowestMs)
+      slowestMs = sensors[i].blockingMs;
+    stale += sensors[i].sim.stats().staleReads;
+  }
+  for (uint8_t a = 0; a < ADAPTERS; a++)
+    ioctls += adapters[a].stats().ioctls;
+
+  printf("%u sensors, %u samples on one thread\n", (unsigned)SENSORS, (unsigned)samples);
+  printf("  wrong values %u, stale reads %u, failures %u\n",
+         (unsigned)wrongValues, (unsigned)stale, (unsigned)failures);
+  printf("  simulated time %.0f ms (slowest sensor alone %u ms, one after the other %u ms)\n",
+         elapsedMs, (unsigned)slowestMs, (unsigned)blockingMs);
+  printf("  %.2f ioctls and %.0f ns of host time per sample\n",
+         (double)ioctls / samples, hostNs / samples);
+
+  bool ok = samples == SENSORS * 2 * SAMPLES && !wrongValues && !stale && !failures;
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+/*
+  Compares reading 16 sensors on one Linux I2C adapter one by one with
+  reading them as a VEML6030LinuxBatch, against the fake adapter in
+  FakeI2CDev.h. Every sensor runs at 25ms integration time and is polled once
+  per integration time for one simulated second. Printed per round: system
+  calls, I2C messages and bus time at 400kHz, plus the host time spent per
+  round, which covers the library and the fake adapter but not the kernel.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_LinuxI2C.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/FakeI2CDev.cpp \
+        extras/host/batch_benchmark.cpp -o batch_benchmark
+    ./batch_benchmark
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_LinuxI2C.h"
+#include "VEML6030Sim.h"
+#include "FakeI2CDev.h"
+#include <chrono>
+#include <stdio.h>
+
+static const uint8_t SENSORS = 16;
+static const uint8_t FIRST_ADDRESS = 0x20; // Behind address translators
+static const uint32_t ROUNDS = 40;         // One second at 25ms
+
+static FakeI2CDev adapter("/dev/i2c-1");
+static VEML6030Sim sims[SENSORS];
+static VEML6030LinuxI2C transports[SENSORS] = {
+  VEML6030LinuxI2C(FIRST_ADDRESS + 0, adapter),  VEML6030LinuxI2C(FIRST_ADDRESS + 1, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 2, adapter),  VEML6030LinuxI2C(FIRST_ADDRESS + 3, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 4, adapter),  VEML6030LinuxI2C(FIRST_ADDRESS + 5, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 6, adapter),  VEML6030LinuxI2C(FIRST_ADDRESS + 7, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 8, adapter),  VEML6030LinuxI2C(FIRST_ADDRESS + 9, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 10, adapter), VEML6030LinuxI2C(FIRST_ADDRESS + 11, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 12, adapter), VEML6030LinuxI2C(FIRST_ADDRESS + 13, adapter),
+  VEML6030LinuxI2C(FIRST_ADDRESS + 14, adapter), VEML6030LinuxI2C(FIRST_ADDRESS + 15, adapter)
+};
+static SparkFun_Ambient_Light_A *sensors[SENSORS];
+
+struct Result
+{
+  double syscalls;
+  double messages;
+  double busTimeUs;
+  double hostNs;
+};
+
+static Result run(bool batched, uint32_t *milliLux)
+{
+  VEML6030LinuxBatch<SENSORS> batch(transports[0]);
+  for (uint8_t i = 0; i < SENSORS; i++)
+    batch.add(*sensors[i], FIRST_ADDRESS + i);
+
+  adapter.resetStats();
+  double hostNs = 0;
+  for (uint32_t round = 0; round < ROUNDS; round++) {
+    delay(25);
+    auto start = std::chrono::steady_clock::now();
+    if (batched) {
+      batch.read();
+      batch.toMilliLux(milliLux);
+    }
+    else {
+      for (uint8_t i = 0; i < SENSORS; i++)
+        milliLux[i] = sensors[i]->readLightMilliLux();
+    }
+    hostNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  const FakeI2CDevStats &s = adapter.stats();
+  Result result = { (double)s.syscalls / ROUNDS, (double)s.messages / ROUNDS,
+                    (double)s.busTimeUs / ROUNDS, hostNs / ROUNDS };
+  return result;
+}
+
+int main()
+{
+  transports[0].open((uint8_t)1);
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    adapter.attach(FIRST_ADDRESS + i, &sims[i]);
+    sims[i].setLux(40.0 * (i + 1));
+    if (i)
+      transports[i].open(transports[0].fd());
+    sensors[i] = new SparkFun_Ambient_Light_A(FIRST_ADDRESS + i);
+    sensors[i]->begin(transports[i]);
+    sensors[i]->setGain(.125);
+    sensors[i]->setIntegTime(25);
+  }
+  delay(100);
+
+  uint32_t single[SENSORS], batched[SENSORS];
+  Result a = run(false, single);
+  Result b = run(true, batched);
+
+  printf("%u sensors, per round:     syscalls  messages  bus us  host ns\n", SENSORS);
+  printf("  one by one             %8.1f  %8.1f  %6.0f  %7.0f\n", a.syscalls, a.messages, a.busTimeUs, a.hostNs);
+  printf("  VEML6030LinuxBatch     %8.1f  %8.1f  %6.0f  %7.0f\n", b.syscalls, b.messages, b.busTimeUs, b.hostNs);
+  printf("  syscalls per second at 25ms: %.0f vs %.0f\n", a.syscalls * 40, b.syscalls * 40);
+
+  int mismatches = 0;
+  for (uint8_t i = 0; i < SENSORS; i++)
+    if (single[i] != batched[i])
+      mismatches++;
+  printf("%s\n", mismatches ? "MISMATCH" : "Values match");
+  return mismatches ? 1 : 0;
+}
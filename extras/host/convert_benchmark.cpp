@@ -0,0 +1,108 @@
+/*
+  Checks VEML6030::convertRawToLux() and VEML6030::rawToLux() against each
+  other and against readLight_A() on the simulated sensor, for every count at
+  every gain and integration time, then measures their throughput. Build with
+  optimisation so the bulk loop is vectorised, from the repository root:
+
+    g++ -std=gnu++11 -O3 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp extras/host/Wire.cpp \
+        extras/host/VEML6030Sim.cpp extras/host/convert_benchmark.cpp -o convert_benchmark
+    ./convert_benchmark
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "VEML6030Sim.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using VEML6030::Gain;
+using VEML6030::IntegTime;
+
+static const Gain gains[] = { Gain::X2, Gain::X1, Gain::X1_4, Gain::X1_8 };
+static const float gainValues[] = { 2, 1, .25, .125 };
+static const IntegTime times[] = { IntegTime::Ms800, IntegTime::Ms400, IntegTime::Ms200,
+                                   IntegTime::Ms100, IntegTime::Ms50, IntegTime::Ms25 };
+static const uint16_t timeValues[] = { 800, 400, 200, 100, 50, 25 };
+
+static VEML6030Sim sim;
+static SparkFun_Ambient_Light_A light(0x48);
+
+// Every count at every setting: bulk against per sample, per sample against
+// the library reading the same count from the (shut down, so frozen) sensor.
+static uint32_t checkExact()
+{
+  std::vector<uint16_t> raw(65536);
+  std::vector<uint32_t> bulk(65536);
+  for (uint32_t i = 0; i < 65536; i++)
+    raw[i] = i;
+
+  uint32_t mismatches = 0;
+  for (uint8_t g = 0; g < 4; g++) {
+    for (uint8_t t = 0; t < 6; t++) {
+      light.setGain(gainValues[g]);
+      light.setIntegTime(timeValues[t]);
+      VEML6030::convertRawToLux(raw.data(), raw.size(), gains[g], times[t], bulk.data());
+
+      for (uint32_t i = 0; i < 65536; i++) {
+        uint32_t scalar = VEML6030::rawToLux(i, gains[g], times[t]);
+        sim.setReg(AMBIENT_LIGHT_DATA_REG, i);
+        uint32_t library = light.readLight_A();
+        if (bulk[i] != scalar || scalar != library) {
+          if (mismatches++ < 10)
+            printf("  mismatch: gain %g, %ums, count %u: bulk %u, rawToLux %u, readLight_A %u\n",
+                   gainValues[g], timeValues[t], (unsigned)i, (unsigned)bulk[i],
+                   (unsigned)scalar, (unsigned)library);
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+template <typename F>
+static double samplesPerSecond(size_t samples, F convert)
+{
+  auto start = std::chrono::steady_clock::now();
+  convert();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return samples / seconds;
+}
+
+int main()
+{
+  Wire.attach(0x48, &sim);
+  light.begin();
+  light.shutDown();
+
+  uint32_t mismatches = checkExact();
+  printf("Bit exactness, 24 settings x 65536 counts: %s (%u mismatches)\n",
+         mismatches ? "FAILED" : "OK", (unsigned)mismatches);
+
+  // A log of 16M samples spread over the whole range, converted at the
+  // coarsest setting so about half of them go through the compensation.
+  const size_t samples = 16 << 20;
+  std::vector<uint16_t> raw(samples);
+  std::vector<uint32_t> out(samples);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < samples; i++) {
+    seed = seed * 1664525 + 1013904223;
+    raw[i] = seed >> 16;
+  }
+
+  volatile uint32_t sink = 0;
+  double scalar = samplesPerSecond(samples, [&] {
+    for (size_t i = 0; i < samples; i++)
+      out[i] = VEML6030::rawToLux(raw[i], Gain::X1_8, IntegTime::Ms25);
+    sink = out[samples / 2];
+  });
+  double bulk = samplesPerSecond(samples, [&] {
+    VEML6030::convertRawToLux(raw.data(), samples, Gain::X1_8, IntegTime::Ms25, out.data());
+    sink = out[samples / 2];
+  });
+  (void)sink;
+
+  printf("rawToLux() per sample: %7.1f M samples/s\n", scalar / 1e6);
+  printf("convertRawToLux():     %7.1f M samples/s (%.1fx)\n", bulk / 1e6, bulk / scalar);
+  return mismatches ? 1 : 0;
+}
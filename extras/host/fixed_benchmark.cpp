@@ -0,0 +1,118 @@
+/*
+  Compares VEML6030Fixed with SparkFun_Ambient_Light_A at the same gain and
+  integration time, on the simulated sensor. For three settings (the finest,
+  gain 1/8 at 100ms as in Example6, and the coarsest) it prints:
+  * the bus transactions and bytes of one readLight_A() with each class
+  * the host time of readLight_A() with each class, the simulated bus
+    included (the same for both)
+  * the host time of the conversion alone: VEML6030Fixed::bitsToLux()
+    against VEML6030::rawToLux(), the runtime class's conversion without the
+    bus, over every count
+  * how many of the 65536 counts convert to different values (the fixed
+    class compensates in fixed point, so it may be one lux apart)
+
+  Flash and RAM on a board come from extras/size_report: its fixed and
+  gain_integ_time sketches are the two classes at gain 1/8 and 100ms.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp extras/host/Wire.cpp \
+        extras/host/VEML6030Sim.cpp extras/host/fixed_benchmark.cpp -o fixed_benchmark
+    ./fixed_benchmark
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Fixed.h"
+#include "VEML6030Sim.h"
+#include <chrono>
+#include <stdio.h>
+
+using VEML6030::Gain;
+using VEML6030::IntegTime;
+
+static const uint32_t READS = 20000;
+static const uint32_t PASSES = 50;    // Passes over all counts
+
+static VEML6030Sim sim;
+static volatile uint32_t sink;
+
+template <typename F>
+static double timeNs(F call, uint32_t count)
+{
+  auto start = std::chrono::steady_clock::now();
+  call();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+template <Gain GAIN, IntegTime TIME>
+static bool compare(const char *name, float gainVal, uint16_t timeVal)
+{
+  typedef VEML6030Fixed<GAIN, TIME> Fixed;
+  static Fixed fixed(0x48);
+  static SparkFun_Ambient_Light_A runtime(0x48);
+
+  sim.setLux(50);
+  if (!fixed.begin() || !runtime.begin() || runtime.setGain(gainVal) != VEML6030_OK ||
+      runtime.setIntegTime(timeVal) != VEML6030_OK) {
+    printf("%s: setup failed\n", name);
+    return false;
+  }
+  delay(timeVal + 10);
+
+  Wire.resetStats();
+  sink = fixed.readLight_A();
+  TwoWireStats fixedBus = Wire.stats();
+  Wire.resetStats();
+  sink = runtime.readLight_A();
+  TwoWireStats runtimeBus = Wire.stats();
+
+  double fixedReadNs = timeNs([] { for (uint32_t i = 0; i < READS; i++) sink = fixed.readLight_A(); }, READS);
+  double runtimeReadNs = timeNs([] { for (uint32_t i = 0; i < READS; i++) sink = runtime.readLight_A(); }, READS);
+
+  double fixedConvNs = timeNs([] {
+    for (uint32_t p = 0; p < PASSES; p++)
+      for (uint32_t raw = 0; raw < 65536; raw++)
+        sink = Fixed::bitsToLux(raw);
+  }, PASSES * 65536);
+  double runtimeConvNs = timeNs([] {
+    for (uint32_t p = 0; p < PASSES; p++)
+      for (uint32_t raw = 0; raw < 65536; raw++)
+        sink = VEML6030::rawToLux(raw, GAIN, TIME);
+  }, PASSES * 65536);
+
+  uint32_t differ = 0, worst = 0;
+  for (uint32_t raw = 0; raw < 65536; raw++) {
+    uint32_t a = Fixed::bitsToLux(raw);
+    uint32_t b = VEML6030::rawToLux(raw, GAIN, TIME);
+    uint32_t d = (a > b) ? a - b : b - a;
+    if (d) {
+      differ++;
+      if (d > worst)
+        worst = d;
+    }
+  }
+
+  printf("%s\n", name);
+  printf("  readLight_A() bus     fixed %u transactions %u bytes, runtime %u transactions %u bytes\n",
+         (unsigned)fixedBus.transactions, (unsigned)(fixedBus.bytesWritten + fixedBus.bytesRead),
+         (unsigned)runtimeBus.transactions, (unsigned)(runtimeBus.bytesWritten + runtimeBus.bytesRead));
+  printf("  readLight_A() host    fixed %7.1f ns, runtime %7.1f ns\n", fixedReadNs, runtimeReadNs);
+  printf("  conversion alone      fixed %7.2f ns, runtime %7.2f ns (%.1fx)\n",
+         fixedConvNs, runtimeConvNs, runtimeConvNs / fixedConvNs);
+  printf("  counts that differ    %u of 65536, by at most %u lux\n", (unsigned)differ, (unsigned)worst);
+
+  return fixedBus.transactions <= runtimeBus.transactions && worst <= 1;
+}
+
+int main()
+{
+  Wire.attach(0x48, &sim);
+
+  bool ok = compare<Gain::X2, IntegTime::Ms800>("Gain 2, 800ms (finest)", 2, 800);
+  ok = compare<Gain::X1_8, IntegTime::Ms100>("Gain 1/8, 100ms (Example6)", .125, 100) && ok;
+  ok = compare<Gain::X1_8, IntegTime::Ms25>("Gain 1/8, 25ms (coarsest)", .125, 25) && ok;
+
+  printf("\n%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
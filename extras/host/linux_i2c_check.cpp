@@ -0,0 +1,70 @@
+/*
+  Runs the library over the Linux i2c-dev backend against a fake adapter and
+  over the host TwoWire against the same kind of simulated sensor, checks that
+  both report the same values and prints the system calls each call costs.
+
+  Build from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_LinuxI2C.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/FakeI2CDev.cpp \
+        extras/host/linux_i2c_check.cpp -o linux_i2c_check
+    ./linux_i2c_check
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_LinuxI2C.h"
+#include "VEML6030Sim.h"
+#include "FakeI2CDev.h"
+#include <stdio.h>
+
+static VEML6030Sim wireSim;
+static VEML6030Sim devSim;
+static FakeI2CDev adapter("/dev/i2c-1");
+static VEML6030LinuxI2C transport(0x48, adapter);
+static SparkFun_Ambient_Light_A overWire(0x48);
+static SparkFun_Ambient_Light_A overDev(0x48);
+static int mismatches = 0;
+
+static void check(const char *name, uint32_t wireValue, uint32_t devValue)
+{
+  const FakeI2CDevStats &s = adapter.stats();
+  printf("  %-18s %8u %8u   %u syscalls %u messages\n", name, (unsigned)wireValue,
+         (unsigned)devValue, (unsigned)s.syscalls, (unsigned)s.messages);
+  if (wireValue != devValue)
+    mismatches++;
+  adapter.resetStats();
+}
+
+int main()
+{
+  Wire.attach(0x48, &wireSim);
+  adapter.attach(0x48, &devSim);
+  wireSim.setLux(320);
+  devSim.setLux(320);
+
+  printf("                       TwoWire  i2c-dev\n");
+  check("open", 1, transport.open((uint8_t)1));
+  check("begin", overWire.begin(), overDev.begin(transport));
+  check("setGain", overWire.setGain(.25), overDev.setGain(.25));
+  check("setIntegTime", overWire.setIntegTime(200), overDev.setIntegTime(200));
+  delay(500);
+  check("readGain", overWire.readGain() * 100, overDev.readGain() * 100);
+  check("readLight_A", overWire.readLight_A(), overDev.readLight_A());
+  check("readLightMilliLux", overWire.readLightMilliLux(), overDev.readLightMilliLux());
+  check("readWhiteLight", overWire.readWhiteLight(), overDev.readWhiteLight());
+  check("setIntHighThresh", overWire.setIntHighThresh(900), overDev.setIntHighThresh(900));
+  check("readHighThresh", overWire.readHighThresh(), overDev.readHighThresh());
+
+  // A NACK on the adapter, recovered by one retry.
+  overDev.setRetryPolicy(1);
+  devSim.failNext(1);
+  adapter.resetStats();
+  uint32_t luxVal = 0;
+  check("retried read", VEML6030_OK, overDev.readLight_A(luxVal));
+  check("value", overWire.readLight_A(), luxVal);
+
+  transport.close();
+  printf("%s\n", mismatches ? "MISMATCH" : "OK");
+  return mismatches ? 1 : 0;
+}
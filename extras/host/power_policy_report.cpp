@@ -0,0 +1,251 @@
+/*
+  Compares power policies of VEML6030PowerController on the simulated sensor.
+
+  Prints the estimates for every level of the default ladder, then runs three
+  scenes of half an hour each under fixed and adaptive policies, each 32
+  times with the scene shifted against the sensor's conversions by a 32nd of
+  the slowest refresh period, so no policy gains from where its conversions
+  happen to fall:
+  * office: 400 lux, the lights go out for five minutes
+  * window: 100 to 900 lux over the half hour, with clouds every few minutes
+  * walk-by: 300 lux, a shadow takes 40% off for two seconds every 20s
+  The light has 1% noise on every conversion. For each run it prints the
+  estimated average current, the samples read, the register writes made by
+  the controller, and the reaction latency to the steps of the scene: the time
+  from a step to the first sample within 10% of the new light level, on
+  average and at worst, and the steps that were over before any sample saw
+  them. Current, samples and writes are per run.
+
+  The report fails unless, in every scene, the adaptive policy misses no more
+  steps than fixed 100ms psm 4, draws less than fixed 50ms, and reacts as fast
+  as fixed 100ms psm 4, on average and at worst, give or take the wait for the
+  first sample after a switch to the fastest level, VEML6030::settleTimeMs(0,
+  50). A change first seen by a conversion that started before it is the one
+  case where staying slow and reading the next conversion would have been
+  quicker. The average gets the same allowance, as over the few steps of a
+  scene it depends on where the adaptive policy's conversions happen to fall.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_PowerControl.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/power_policy_report.cpp \
+        -o power_policy_report
+    ./power_policy_report
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_PowerControl.h"
+#include "VEML6030Sim.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+static const uint32_t RUN_MS = 30 * 60 * 1000UL;
+static const uint32_t PHASES = 32;
+static const uint32_t PHASE_MS = 4100 / PHASES;   // Of fixed 100ms psm 4
+
+static uint32_t randomState = 12345;
+static double noise()
+{
+  randomState = randomState * 1664525 + 1013904223;
+  return 0.01 * ((int32_t)(randomState >> 16) - 32768) / 32768.0;
+}
+
+// A scene: the light without noise at a time in ms since the start of the
+// run, and the times of its steps.
+struct Scene
+{
+  const char *name;
+  double (*lux)(uint32_t ms);
+  std::vector<uint32_t> steps;
+};
+
+static double office(uint32_t ms)
+{
+  return (ms >= 20 * 60000UL && ms < 25 * 60000UL) ? 5 : 400;
+}
+
+static double window(uint32_t ms)
+{
+  double base = 100 + 800.0 * ms / RUN_MS;
+  uint32_t period = ms / 200000; // a new cloud every 200s
+  return (period & 1) ? base * .55 : base;
+}
+
+static double walkBy(uint32_t ms)
+{
+  return (ms % 20000 < 2000) ? 180 : 300;
+}
+
+struct Result
+{
+  float currentUA;
+  uint32_t samples;
+  uint32_t writes;
+  uint64_t latencySum;
+  uint32_t seen;            // Steps a sample saw
+  uint32_t worstLatencyMs;
+  uint32_t missed;          // Steps undone before any sample saw them
+
+  uint32_t meanLatencyMs() const { return seen ? latencySum / seen : 0; }
+};
+
+// One run, with the scene starting phaseMs after the controller.
+static Result run(const Scene &scene, const VEML6030PowerPolicy &policy, uint32_t phaseMs)
+{
+  VEML6030Sim sim;
+  Wire.attach(0x48, &sim);
+  uint64_t startUs = simMicros64() + 1000;
+  uint64_t sceneUs = startUs + phaseMs * 1000ULL;
+  double (*lux)(uint32_t) = scene.lux;
+  sim.setScene([sceneUs, lux](uint64_t us) {
+    uint32_t ms = (us > sceneUs) ? (us - sceneUs) / 1000 : 0;
+    return lux(ms) * (1 + noise());
+  });
+
+  SparkFun_Ambient_Light_A light(0x48);
+  light.begin();
+  light.enableShadowCache();
+  light.setGain(1);
+  simAdvanceMicros(startUs - simMicros64());
+
+  VEML6030PowerController controller(light);
+  uint32_t start = millis();
+  controller.begin(policy, start);
+
+  Result result = Result();
+  size_t nextStep = 0;
+  uint32_t pendingStep = 0;
+  bool waiting = false;
+
+  for (;;) {
+    uint32_t now = millis();
+    if (now - start >= RUN_MS + phaseMs)
+      break;
+    uint32_t t = (now - start > phaseMs) ? now - start - phaseMs : 0;
+
+    if (nextStep < scene.steps.size() && t >= scene.steps[nextStep]) {
+      if (waiting)
+        result.missed++;
+      pendingStep = scene.steps[nextStep++];
+      waiting = true;
+    }
+
+    if (controller.poll(now)) {
+      result.samples++;
+      double expected = lux(t);
+      double measured = controller.milliLux() / 1000.0;
+      if (waiting && fabs(measured - expected) < .1 * expected) {
+        uint32_t latency = t - pendingStep;
+        result.latencySum += latency;
+        result.seen++;
+        if (latency > result.worstLatencyMs)
+          result.worstLatencyMs = latency;
+        waiting = false;
+      }
+    }
+
+    // Sleep until the next sample or the next step of the scene.
+    uint32_t elapsed = now - start;
+    uint32_t due = controller.nextDueAt() - start;
+    if (nextStep < scene.steps.size() && scene.steps[nextStep] + phaseMs < due)
+      due = scene.steps[nextStep] + phaseMs;
+    simAdvanceMicros((due > elapsed ? due - elapsed : 1) * 1000ULL);
+  }
+
+  result.currentUA = controller.averageCurrentUA(millis());
+  result.writes = controller.writes();
+  if (waiting)
+    result.missed++;
+  return result;
+}
+
+int main()
+{
+  VEML6030PowerPolicy adaptive;
+
+  printf("Levels of the default policy\n");
+  printf("level  integ  psm  refresh ms  current uA  reaction ms\n");
+  for (uint8_t i = 0; i < adaptive.levelCount; i++) {
+    const VEML6030PowerLevel &level = adaptive.levels[i];
+    printf("%5u  %5u  %3u  %10u  %10.1f  %11u\n", i,
+           VEML6030::refreshTimeMs(level.time, 0), level.psmMode,
+           VEML6030::refreshTimeMs(level.time, level.psmMode),
+           VEML6030PowerController::currentUA(level),
+           (unsigned)VEML6030PowerController::reactionMs(level));
+  }
+
+  // Fixed policies are ladders of one level.
+  static const VEML6030PowerLevel fast[] = { { VEML6030::IntegTime::Ms50, 0 } };
+  static const VEML6030PowerLevel slow[] = { { VEML6030::IntegTime::Ms100, 4 } };
+  VEML6030PowerPolicy fixedFast, fixedSlow, eager;
+  fixedFast.levels = fast;
+  fixedFast.levelCount = 1;
+  fixedSlow.levels = slow;
+  fixedSlow.levelCount = 1;
+  eager.calmMs = 3000;
+
+  struct { const char *name; const VEML6030PowerPolicy *policy; } policies[] = {
+    { "fixed 50ms",          &fixedFast },
+    { "fixed 100ms psm 4",   &fixedSlow },
+    { "adaptive",            &adaptive },
+    { "adaptive, calm 3s",   &eager }
+  };
+
+  std::vector<uint32_t> officeSteps, windowSteps, walkSteps;
+  officeSteps.push_back(20 * 60000UL);
+  officeSteps.push_back(25 * 60000UL);
+  for (uint32_t ms = 200000; ms < RUN_MS; ms += 200000)
+    windowSteps.push_back(ms);
+  for (uint32_t ms = 20000; ms < RUN_MS; ms += 20000) {
+    walkSteps.push_back(ms);
+    walkSteps.push_back(ms + 2000);
+  }
+
+  Scene scenes[] = {
+    { "office", office, officeSteps },
+    { "window", window, windowSteps },
+    { "walk-by", walkBy, walkSteps }
+  };
+
+  bool ok = true;
+  for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+    printf("\n%s, 30 minutes, %u steps\n", scenes[s].name, (unsigned)scenes[s].steps.size());
+    printf("policy               current uA  samples  writes  latency ms  worst ms  missed\n");
+    Result total[sizeof(policies) / sizeof(policies[0])];
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+      Result &r = total[p];
+      r = Result();
+      for (uint32_t phase = 0; phase < PHASES; phase++) {
+        Result one = run(scenes[s], *policies[p].policy, phase * PHASE_MS);
+        r.currentUA += one.currentUA / PHASES;
+        r.samples += one.samples;
+        r.writes += one.writes;
+        r.latencySum += one.latencySum;
+        r.seen += one.seen;
+        if (one.worstLatencyMs > r.worstLatencyMs)
+          r.worstLatencyMs = one.worstLatencyMs;
+        r.missed += one.missed;
+        if (one.samples == 0)
+          ok = false;
+      }
+      printf("%-20s %10.2f  %7u  %6u  %10u  %8u  %6u\n", policies[p].name, r.currentUA,
+             (unsigned)(r.samples / PHASES), (unsigned)(r.writes / PHASES), (unsigned)r.meanLatencyMs(),
+             (unsigned)r.worstLatencyMs, (unsigned)r.missed);
+    }
+
+    // total[0] is fixed 50ms, total[1] fixed 100ms psm 4, total[2] adaptive.
+    const Result &fastest = total[0], &slow = total[1], &adapt = total[2];
+    uint32_t switchMs = VEML6030::settleTimeMs(0, VEML6030::refreshTimeMs(adaptive.levels[0].time, 0));
+    if (adapt.meanLatencyMs() > slow.meanLatencyMs() + switchMs || adapt.worstLatencyMs > slow.worstLatencyMs + switchMs ||
+        adapt.missed > slow.missed || adapt.currentUA >= fastest.currentUA) {
+      printf("adaptive is slower than fixed 100ms psm 4 by more than %ums, or draws as much as fixed 50ms\n",
+             (unsigned)switchMs);
+      ok = false;
+    }
+  }
+
+  printf("\n%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
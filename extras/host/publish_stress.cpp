@@ -0,0 +1,222 @@
+/*
+  Checks and measures VEML6030Publisher.
+
+  1. One publish from the simulated sensor: the reading matches the light
+     and the settings, and costs three register reads with the shadow cache
+     on.
+  2. Stress: one owner thread publishes as fast as it can while reader
+     threads copy the latest reading. Every field of a published reading is
+     derived from its sequence, so a torn copy cannot go unnoticed; each
+     reader also checks that the sequence never goes backwards.
+  3. Contention: reads per second with 1 to 8 reader threads, with the owner
+     publishing at 1kHz and flat out, against the same copy under a
+     std::mutex. Run it on a machine with several cores to see readers scale;
+     on one core the threads only take turns.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -pthread -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_Publisher.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/publish_stress.cpp \
+        -o publish_stress
+    ./publish_stress
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Publisher.h"
+#include "VEML6030Sim.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const float GAINS[] = { .125, .25, 1, 2 };
+static const uint16_t TIMES[] = { 25, 50, 100, 200, 400, 800 };
+
+// A reading whose every field follows from the sequence.
+static VEML6030Published derived(uint32_t sequence)
+{
+  VEML6030Published r;
+  memset(&r, 0, sizeof(r));
+  r.sequence = sequence;
+  r.timestamp = sequence * 7;
+  r.snapshot.ambientRaw = sequence & 0xFFFF;
+  r.snapshot.whiteRaw = ~sequence & 0xFFFF;
+  r.snapshot.interrupt = sequence % 3;
+  r.snapshot.ambientLux = sequence * 3;
+  r.snapshot.whiteLux = sequence ^ 0xA5A5A5A5;
+  r.gain = GAINS[sequence % 4];
+  r.integTime = TIMES[sequence % 6];
+  r.powSavMode = sequence % 5;
+  r.convStep = sequence % 10;
+  return r;
+}
+
+static bool consistent(const VEML6030Published &r)
+{
+  VEML6030Published want = derived(r.sequence);
+  return memcmp(&r, &want, sizeof(r)) == 0;
+}
+
+static uint32_t checkSensor()
+{
+  uint32_t failures = 0;
+  VEML6030Sim sim;
+  sim.setLux(321);
+  Wire.attach(0x48, &sim);
+
+  SparkFun_Ambient_Light_A light(0x48);
+  light.begin();
+  light.enableShadowCache();
+  light.setGain(.25);
+  light.setIntegTime(200);
+  light.setPowSavMode(2);
+  light.enablePowSave();
+  delay(1500);
+
+  VEML6030Publisher publisher;
+  VEML6030Published r;
+  if (publisher.read(r) || publisher.sequence() != 0)
+    failures++;
+
+  Wire.resetStats();
+  uint32_t now = millis();
+  if (publisher.publish(light, now) != VEML6030_OK)
+    failures++;
+  uint32_t transactions = Wire.stats().transactions;
+
+  if (!publisher.read(r) || r.sequence != 1 || publisher.sequence() != 1)
+    failures++;
+  if (r.snapshot.ambientLux < 319 || r.snapshot.ambientLux > 322 || r.gain != .25f ||
+      r.integTime != 200 || r.powSavMode != 2 || r.convStep != light.readConvStep() ||
+      r.timestamp != now)
+    failures++;
+
+  // A failing read publishes nothing.
+  sim.failNext(1);
+  if (publisher.publish(light, millis()) == VEML6030_OK || publisher.sequence() != 1)
+    failures++;
+
+  printf("Publish from the sensor: %u lux, %u transactions, %s\n", (unsigned)r.snapshot.ambientLux,
+         (unsigned)transactions, failures ? "FAILED" : "OK");
+  return failures + (transactions != 3);
+}
+
+static uint32_t stress(unsigned readers, double seconds)
+{
+  VEML6030Publisher publisher;
+  std::atomic<bool> stop(false);
+  std::atomic<uint32_t> torn(0), backwards(0);
+  std::atomic<uint64_t> reads(0), retries(0);
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < readers; i++) {
+    threads.push_back(std::thread([&]() {
+      uint32_t last = 0;
+      uint64_t n = 0, failed = 0;
+      VEML6030Published r;
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (!publisher.tryRead(r)) {
+          failed++;
+          if (!publisher.read(r))
+            continue;
+        }
+        n++;
+        if (!consistent(r))
+          torn++;
+        if (r.sequence < last)
+          backwards++;
+        last = r.sequence;
+      }
+      reads += n;
+      retries += failed;
+    }));
+  }
+
+  uint32_t sequence = 0;
+  auto end = Clock::now() + std::chrono::duration<double>(seconds);
+  while (Clock::now() < end) {
+    for (int i = 0; i < 1000; i++)
+      publisher.publish(derived(++sequence));
+  }
+  stop = true;
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+
+  printf("Stress, %u readers for %.1fs: %u publishes, %llu reads, %llu missed first attempts, "
+         "%u torn, %u out of order\n", readers, seconds, (unsigned)sequence,
+         (unsigned long long)reads.load(), (unsigned long long)retries.load(),
+         (unsigned)torn.load(), (unsigned)backwards.load());
+  return torn + backwards + (sequence != publisher.sequence());
+}
+
+// The alternative: the same reading behind a mutex.
+struct Locked
+{
+  void publish(const VEML6030Published &r){ std::lock_guard<std::mutex> lock(m); value = r; }
+  bool read(VEML6030Published &r){ std::lock_guard<std::mutex> lock(m); r = value; return true; }
+  std::mutex m;
+  VEML6030Published value;
+};
+
+template <typename Shared>
+static double readRate(Shared &shared, unsigned readers, bool flatOut, double seconds)
+{
+  std::atomic<bool> stop(false);
+  std::atomic<uint64_t> reads(0);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < readers; i++) {
+    threads.push_back(std::thread([&]() {
+      uint64_t n = 0;
+      uint32_t sum = 0;
+      VEML6030Published r;
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (shared.read(r))
+          sum += r.snapshot.ambientLux;
+        n++;
+      }
+      reads += n + (sum == 1); // Keeps the copy from being optimised away
+    }));
+  }
+
+  uint32_t sequence = 0;
+  auto start = Clock::now();
+  auto end = start + std::chrono::duration<double>(seconds);
+  while (Clock::now() < end) {
+    shared.publish(derived(++sequence));
+    if (!flatOut)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  stop = true;
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  return reads / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main()
+{
+  uint32_t failures = checkSensor();
+
+  unsigned cores = std::thread::hardware_concurrency();
+  failures += stress(cores > 4 ? cores - 1 : 3, 1.0);
+
+  printf("\nReads per second, all readers together (%u cores)\n", cores);
+  printf("readers  owner      VEML6030Publisher   std::mutex\n");
+  for (unsigned readers = 1; readers <= 8; readers *= 2) {
+    for (int flatOut = 0; flatOut <= 1; flatOut++) {
+      VEML6030Publisher publisher;
+      Locked locked;
+      double lockFree = readRate(publisher, readers, flatOut, .3);
+      double mutex = readRate(locked, readers, flatOut, .3);
+      printf("%7u  %-9s  %17.3g  %11.3g\n", readers, flatOut ? "flat out" : "1kHz", lockFree, mutex);
+    }
+  }
+
+  printf("\n%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
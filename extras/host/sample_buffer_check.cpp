@@ -0,0 +1,175 @@
+/*
+  Check of VEML6030SampleBuffer against statistics recomputed from scratch.
+
+  1. Random samples (counts and conversion steps) are pushed into a 64 sample
+     buffer. After every push the window (the samples held, oldest first) and
+     the stream statistics are compared with a two pass computation in long
+     double over the same samples.
+  2. A long stream of bright samples, normalized values close to 2^25, with a
+     small spread: the case where the stream variance needs more than float.
+  3. sample() on the simulated sensor: a read that fails stores nothing, and
+     a sensor whose begin() lost its settings read still stores the right
+     conversion step.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp extras/host/Wire.cpp \
+        extras/host/VEML6030Sim.cpp extras/host/sample_buffer_check.cpp -o sample_buffer_check
+    ./sample_buffer_check
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_SampleBuffer.h"
+#include "VEML6030Sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const uint16_t CAPACITY = 64;
+static const long double LUX_PER_UNIT = .0036L;
+
+static uint32_t seed = 12345;
+static uint32_t nextRandom()
+{
+  seed = seed * 1664525 + 1013904223;
+  return seed;
+}
+
+struct Reference
+{
+  long double mean, variance, min, max;
+};
+
+// Two pass statistics in lux over values[first, values.size()).
+static Reference reference(const std::vector<uint32_t> &values, size_t first)
+{
+  Reference r = { 0, 0, 0, 0 };
+  size_t n = values.size() - first;
+  if (!n)
+    return r;
+  r.min = r.max = values[first];
+  for (size_t i = first; i < values.size(); i++) {
+    r.mean += values[i];
+    if (values[i] < r.min)
+      r.min = values[i];
+    if (values[i] > r.max)
+      r.max = values[i];
+  }
+  r.mean /= n;
+  for (size_t i = first; i < values.size(); i++)
+    r.variance += (values[i] - r.mean) * (values[i] - r.mean);
+  r.variance = (n > 1) ? r.variance / (n - 1) : 0;
+
+  r.mean *= LUX_PER_UNIT;
+  r.variance *= LUX_PER_UNIT * LUX_PER_UNIT;
+  r.min *= LUX_PER_UNIT;
+  r.max *= LUX_PER_UNIT;
+  return r;
+}
+
+// Relative error, against an absolute floor for values close to 0.
+static double error(float got, long double want)
+{
+  long double scale = fabsl(want) > 1 ? fabsl(want) : 1;
+  return (double)(fabsl(got - want) / scale);
+}
+
+static uint32_t failures = 0;
+static void expect(bool ok, const char *what)
+{
+  if (!ok) {
+    failures++;
+    if (failures <= 10)
+      printf("  FAILED: %s\n", what);
+  }
+}
+
+int main()
+{
+  // 1. Random samples against the reference.
+  static VEML6030SampleBuffer<CAPACITY> buffer;
+  std::vector<uint32_t> values;
+  std::vector<VEML6030RawSample> samples;
+  double worstWindow = 0, worstStream = 0;
+
+  for (uint32_t i = 0; i < 5000; i++) {
+    VEML6030RawSample s;
+    s.timestamp = i * 100;
+    s.raw = nextRandom() >> 16;
+    s.convStep = nextRandom() % 10;
+    buffer.push(s.timestamp, s.raw, s.convStep);
+    samples.push_back(s);
+    values.push_back(s.normalized());
+
+    size_t first = values.size() > CAPACITY ? values.size() - CAPACITY : 0;
+    expect(buffer.size() == values.size() - first, "window size");
+    for (uint16_t j = 0; j < buffer.size(); j++) {
+      const VEML6030RawSample &held = buffer[j];
+      const VEML6030RawSample &want = samples[first + j];
+      expect(held.timestamp == want.timestamp && held.raw == want.raw && held.convStep == want.convStep,
+             "window order");
+    }
+
+    Reference window = reference(values, first);
+    double e = error(buffer.windowMeanLux(), window.mean);
+    e = fmax(e, error(buffer.windowVarianceLux(), window.variance));
+    e = fmax(e, error(buffer.windowMinLux(), window.min));
+    e = fmax(e, error(buffer.windowMaxLux(), window.max));
+    if (e > worstWindow)
+      worstWindow = e;
+
+    Reference stream = reference(values, 0);
+    e = error(buffer.meanLux(), stream.mean);
+    e = fmax(e, error(buffer.varianceLux(), stream.variance));
+    e = fmax(e, error(buffer.minLux(), stream.min));
+    e = fmax(e, error(buffer.maxLux(), stream.max));
+    if (e > worstStream)
+      worstStream = e;
+  }
+  expect(buffer.count() == values.size(), "stream count");
+  expect(worstWindow < 1e-5, "window statistics");
+  expect(worstStream < 1e-5, "stream statistics");
+  printf("Random samples:   worst relative error window %.2e, stream %.2e\n", worstWindow, worstStream);
+
+  // 2. Bright, steady light: large normalized values, small variance.
+  buffer.clear();
+  values.clear();
+  for (uint32_t i = 0; i < 200000; i++) {
+    uint16_t raw = 65000 + nextRandom() % 500;
+    buffer.push(i, raw, 9);
+    values.push_back((uint32_t)raw << 9);
+  }
+  Reference bright = reference(values, 0);
+  double brightError = error(buffer.varianceLux(), bright.variance);
+  expect(brightError < 1e-5, "stream variance of bright samples");
+  printf("Bright samples:   variance %.1f lux^2, reference %.1f lux^2, relative error %.2e\n",
+         buffer.varianceLux(), (double)bright.variance, brightError);
+
+  // 3. sample() on the simulated sensor.
+  static VEML6030Sim sim;
+  static SparkFun_Ambient_Light_A light(0x48);
+  static SparkFun_Ambient_Light_A glitched(0x48);
+  Wire.attach(0x48, &sim);
+  sim.setLux(300);
+  light.begin();
+  delay(200);
+
+  buffer.clear();
+  expect(buffer.sample(light, 1) == VEML6030_OK && buffer.size() == 1, "sample() stores a good read");
+  sim.failNext(1);
+  expect(buffer.sample(light, 2) == VEML6030_BUS_ERROR, "sample() reports a failed read");
+  expect(buffer.size() == 1 && buffer.count() == 1 && buffer.newest().timestamp == 1,
+         "sample() stores nothing on a failed read");
+
+  sim.failNext(1);
+  glitched.begin();
+  delay(200);
+  expect(buffer.sample(glitched, 3) == VEML6030_OK && buffer.newest().convStep == light.readConvStep(),
+         "sample() after a failed begin() stores the right conversion step");
+  printf("sample():         %u samples stored, newest %.2f lux\n",
+         (unsigned)buffer.size(), buffer.newest().milliLux() / 1000.0);
+
+  printf("\n%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
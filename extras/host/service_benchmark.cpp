@@ -0,0 +1,365 @@
+/*
+  Measures VEML6030Service.
+
+  1. The timer wheel alone: timers with the sensor's refresh times expiring
+     and being rescheduled for ten simulated seconds, 1000 to 100000 of
+     them, against a binary heap (std::priority_queue).
+  2. Scaling, on simulated time: 1000 to 16000 simulated sensors on four
+     buses, at every integration time, a quarter of them in power save mode,
+     driven through begin() and poll() for ten simulated seconds. Printed per
+     sample: host time spent in poll() and timers expired, against polling
+     every sensor every millisecond from one loop. Every sample has to be a
+     new conversion (the simulated sensor counts stale reads). The share of
+     conversions never read comes from the millisecond takeSample() adds to
+     each period: about one conversion in P is passed over at P ms.
+  3. Threads, on the real clock: 2000 sensors on four buses, one worker
+     each, for three seconds. The sensors here count their conversions from
+     the real clock and return the count as the reading, so a repeated or
+     skipped conversion shows up in the samples.
+  4. A service clock far from millis(): one simulated sensor whose callback
+     changes the integration time after every sample, so each wait restarts.
+     The sensor has to be read about once per conversion, not once per turn
+     of the wheel.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -pthread -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_Service.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/service_benchmark.cpp \
+        -o service_benchmark
+    ./service_benchmark
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Service.h"
+#include "VEML6030Sim.h"
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint8_t BUSES = 4;
+static const uint16_t INTEG_TIMES[] = { 25, 50, 100, 200, 400, 800 };
+
+// Talks to a simulated sensor directly, without a simulated bus, so only
+// the service's own work moves the clock.
+class SimTransport : public VEML6030Transport
+{
+  public:
+    SimTransport(VEML6030Sim &sim) : VEML6030Transport(0x48), _sim(sim) {}
+    bool isConnected(){ return true; }
+  protected:
+    VEML6030_STATUS _writeOnce(uint8_t reg, uint16_t value){
+      uint8_t data[3] = { reg, (uint8_t)value, (uint8_t)(value >> 8) };
+      return _sim.i2cWrite(data, 3) ? VEML6030_OK : VEML6030_BUS_ERROR;
+    }
+    VEML6030_STATUS _readOnce(uint8_t reg, uint16_t &value){
+      uint8_t data[2];
+      if (!_sim.i2cWrite(&reg, 1) || !_sim.i2cRead(data, 2))
+        return VEML6030_BUS_ERROR;
+      value = data[0] | (data[1] << 8);
+      return VEML6030_OK;
+    }
+  private:
+    VEML6030Sim &_sim;
+};
+
+// A sensor on the real clock whose reading is the number of conversions
+// completed since it was powered up.
+class CountingTransport : public VEML6030Transport
+{
+  public:
+    CountingTransport() : VEML6030Transport(0x48), _setting(1), _powerSave(0), _wakeUs(0) {}
+    bool isConnected(){ return true; }
+    static uint64_t nowUs(){
+      static const Clock::time_point start = Clock::now();
+      return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+  protected:
+    VEML6030_STATUS _writeOnce(uint8_t reg, uint16_t value){
+      if (reg == SETTING_REG || reg == POWER_SAVE_REG)
+        _wakeUs = nowUs();
+      if (reg == SETTING_REG)
+        _setting = value;
+      if (reg == POWER_SAVE_REG)
+        _powerSave = value;
+      return VEML6030_OK;
+    }
+    VEML6030_STATUS _readOnce(uint8_t reg, uint16_t &value){
+      if (reg == AMBIENT_LIGHT_DATA_REG) {
+        uint64_t period = VEML6030Sim::integTimeUs(_setting);
+        if (_powerSave & 1)
+          period += 500000ULL << ((_powerSave >> 1) & 3);
+        value = (_setting & 1) ? 0 : (uint16_t)((nowUs() - _wakeUs) / period);
+      }
+      else
+        value = (reg == SETTING_REG) ? _setting : (reg == POWER_SAVE_REG) ? _powerSave : 0;
+      return VEML6030_OK;
+    }
+  private:
+    uint16_t _setting;
+    uint16_t _powerSave;
+    uint64_t _wakeUs;
+};
+
+static const uint16_t REFRESH[] = { 25, 50, 100, 200, 400, 800, 600, 1100, 2200, 4400 };
+
+struct HeapEntry
+{
+  uint32_t dueAt;
+  uint32_t index;
+  bool operator<(const HeapEntry &other) const { return dueAt > other.dueAt; }
+};
+
+static void wheelOnly(uint32_t count)
+{
+  std::vector<VEML6030TimerWheel::Timer> timers(count);
+  std::vector<uint16_t> period(count);
+  std::unique_ptr<VEML6030TimerWheel> wheel(new VEML6030TimerWheel(0));
+  std::priority_queue<HeapEntry> heap;
+  for (uint32_t i = 0; i < count; i++) {
+    period[i] = REFRESH[i % 10];
+    wheel->schedule(timers[i], 1 + (i * 7919) % period[i]);
+    HeapEntry e = { timers[i].dueAt, i };
+    heap.push(e);
+  }
+
+  uint64_t expired = 0;
+  auto t0 = Clock::now();
+  for (uint32_t now = 1; now <= 10000; now++) {
+    VEML6030TimerWheel::Timer *timer = wheel->advance(now);
+    while (timer) {
+      VEML6030TimerWheel::Timer *next = timer->next;
+      wheel->schedule(*timer, now + period[timer - &timers[0]]);
+      expired++;
+      timer = next;
+    }
+  }
+  double wheelNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+  uint64_t popped = 0;
+  t0 = Clock::now();
+  for (uint32_t now = 1; now <= 10000; now++) {
+    while (heap.top().dueAt <= now) {
+      HeapEntry e = heap.top();
+      heap.pop();
+      e.dueAt = now + period[e.index];
+      heap.push(e);
+      popped++;
+    }
+  }
+  double heapNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+  printf("%8u  %9llu  %10.1f  %10.1f\n", (unsigned)count, (unsigned long long)expired,
+         wheelNs / expired, heapNs / popped);
+}
+
+static void configure(SparkFun_Ambient_Light_A &light, uint32_t i)
+{
+  light.enableShadowCache();
+  light.setGain(.25);
+  light.setIntegTime(INTEG_TIMES[i % 6]);
+  if (i % 4 == 3) {
+    light.setPowSavMode(1 + (i / 4) % 4);
+    light.enablePowSave();
+  }
+}
+
+static uint64_t simSamples;
+static void countSample(SparkFun_Ambient_Light_A &, const VEML6030RawSample &){ simSamples++; }
+
+static void scaling(uint32_t count)
+{
+  std::vector<std::unique_ptr<VEML6030Sim> > sims;
+  std::vector<std::unique_ptr<SimTransport> > transports;
+  std::vector<std::unique_ptr<SparkFun_Ambient_Light_A> > lights;
+  VEML6030Service service;
+
+  for (uint32_t i = 0; i < count; i++) {
+    sims.emplace_back(new VEML6030Sim());
+    sims.back()->setLux(100);
+    transports.emplace_back(new SimTransport(*sims.back()));
+    lights.emplace_back(new SparkFun_Ambient_Light_A(0x48));
+    lights.back()->begin(*transports.back());
+    configure(*lights.back(), i);
+    service.add(*lights.back(), i % BUSES, countSample);
+  }
+  // Setting up took simulated time; let the sensors catch up before counting.
+  for (uint32_t i = 0; i < count; i++) {
+    sims[i]->reg(SETTING_REG);
+    sims[i]->resetStats();
+  }
+
+  // Event loop: every bus once, then straight to the earliest due time.
+  simSamples = 0;
+  double pollNs = 0;
+  uint32_t start = millis();
+  service.begin(start);
+  while (millis() - start < 10000) {
+    uint32_t now = millis();
+    uint32_t next = now + VEML6030TimerWheel::SLOTS;
+    auto t0 = Clock::now();
+    for (uint8_t b = 0; b < BUSES; b++) {
+      uint32_t due = service.poll(b, now);
+      if ((int32_t)(due - next) < 0)
+        next = due;
+    }
+    pollNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    simAdvanceMicros(next * 1000ULL - simMicros64());
+  }
+
+  uint64_t expired = 0, stale = 0, conversions = 0;
+  for (uint8_t b = 0; b < BUSES; b++)
+    expired += service.stats(b).expired;
+  for (uint32_t i = 0; i < count; i++) {
+    stale += sims[i]->stats().staleReads;
+    conversions += sims[i]->stats().conversions;
+  }
+
+  // The same sensors polled every millisecond for one simulated second.
+  auto t0 = Clock::now();
+  uint64_t naiveSamples = 0;
+  for (uint32_t ms = 0; ms < 1000; ms++) {
+    uint32_t now = millis();
+    for (uint32_t i = 0; i < count; i++) {
+      if (lights[i]->poll(now)) {
+        lights[i]->takeSampleRaw();
+        naiveSamples++;
+      }
+    }
+    simAdvanceMicros(1000);
+  }
+  double naiveNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+  printf("%6u  %8llu  %9.0f  %9.2f  %10.0f  %5llu  %7.2f%%\n", (unsigned)count,
+         (unsigned long long)simSamples, pollNs / simSamples, (double)expired / simSamples,
+         naiveNs / naiveSamples, (unsigned long long)stale,
+         100.0 * (conversions - simSamples) / conversions);
+}
+
+static std::vector<uint16_t> lastCount;
+static std::vector<uint32_t> repeats, skips, received;
+static std::unique_ptr<SparkFun_Ambient_Light_A> *threadLights;
+
+static void checkCount(SparkFun_Ambient_Light_A &sensor, const VEML6030RawSample &sample)
+{
+  size_t i = 0;
+  while (threadLights[i].get() != &sensor)
+    i++;
+  if (received[i]++ > 0) {
+    if (sample.raw == lastCount[i])
+      repeats[i]++;
+    else
+      skips[i] += (uint16_t)(sample.raw - lastCount[i]) - 1;
+  }
+  lastCount[i] = sample.raw;
+}
+
+static uint32_t realMillis(){ return CountingTransport::nowUs() / 1000; }
+
+static bool threads(uint32_t count, double seconds)
+{
+  std::vector<std::unique_ptr<CountingTransport> > transports;
+  std::vector<std::unique_ptr<SparkFun_Ambient_Light_A> > lights;
+  VEML6030Service service(realMillis);
+
+  lastCount.assign(count, 0);
+  repeats.assign(count, 0);
+  skips.assign(count, 0);
+  received.assign(count, 0);
+  for (uint32_t i = 0; i < count; i++) {
+    transports.emplace_back(new CountingTransport());
+    lights.emplace_back(new SparkFun_Ambient_Light_A(0x48));
+    lights.back()->begin(*transports.back());
+    configure(*lights.back(), i);
+    service.add(*lights.back(), i % BUSES, checkCount);
+  }
+  threadLights = lights.data();
+
+  service.start();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  service.stop();
+
+  uint64_t samples = 0, repeated = 0, skipped = 0;
+  uint32_t late = 0, wakeups = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    repeated += repeats[i];
+    skipped += skips[i];
+  }
+  for (uint8_t b = 0; b < BUSES; b++) {
+    VEML6030ServiceStats s = service.stats(b);
+    samples += s.samples;
+    wakeups += s.wakeups;
+    if (s.worstLateMs > late)
+      late = s.worstLateMs;
+  }
+
+  printf("%u sensors, %u workers, %.0fs: %llu samples, %u wakeups, %llu repeated, %llu skipped "
+         "conversions (%.2f%%), worst lateness %u ms\n", (unsigned)count, (unsigned)BUSES, seconds,
+         (unsigned long long)samples, (unsigned)wakeups, (unsigned long long)repeated,
+         (unsigned long long)skipped, 100.0 * skipped / (samples + skipped), (unsigned)late);
+  return repeated == 0;
+}
+
+static uint32_t switchedSamples;
+static void switchIntegTime(SparkFun_Ambient_Light_A &light, const VEML6030RawSample &)
+{
+  light.setIntegTime(switchedSamples++ % 2 ? 25 : 50);
+}
+
+static uint32_t behindMillis(){ return millis() - 0x40000000; }
+
+static bool ownClock()
+{
+  VEML6030Sim sim;
+  sim.setLux(100);
+  SimTransport transport(sim);
+  SparkFun_Ambient_Light_A light(0x48);
+  light.begin(transport);
+  light.enableShadowCache();
+  VEML6030Service service(behindMillis);
+  service.add(light, 0, switchIntegTime);
+  switchedSamples = 0;
+  sim.resetStats();
+
+  uint32_t start = behindMillis();
+  service.begin(start);
+  while (behindMillis() - start < 10000) {
+    uint32_t due = service.poll(0, behindMillis());
+    simAdvanceMicros((uint64_t)(due - behindMillis()) * 1000);
+  }
+
+  // Each sample waits VEML6030::settleTimeMs() after the switch: at most the
+  // 50ms refresh period before it and the 50ms integration time after it.
+  printf("Service clock 2^30 ms behind millis(), integration time switched after every sample:\n"
+         "  %u samples in 10s, %u stale\n", (unsigned)switchedSamples,
+         (unsigned)sim.stats().staleReads);
+  return switchedSamples >= 10000 / VEML6030::settleTimeMs(50, 50) && sim.stats().staleReads == 0;
+}
+
+int main()
+{
+  printf("Timer wheel alone, ten simulated seconds\n");
+  printf("  timers    expired  wheel ns/   heap ns/\n                          expiry      expiry\n");
+  for (uint32_t count = 1000; count <= 100000; count *= 10)
+    wheelOnly(count);
+  printf("\n");
+
+  printf("Simulated, ten seconds, %u buses\n", (unsigned)BUSES);
+  printf("sensors   samples  ns/sample  timers/  every ms   stale  missed\n");
+  printf("                   (service)   sample  ns/sample\n");
+  for (uint32_t count = 1000; count <= 16000; count *= 2)
+    scaling(count);
+  printf("\n");
+
+  bool ok = threads(2000, 3);
+  printf("\n");
+
+  ok = ownClock() && ok;
+  printf("\n%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
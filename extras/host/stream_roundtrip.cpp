@@ -0,0 +1,180 @@
+/*
+  Round trip check of VEML6030StreamEncoder and VEML6030StreamDecoder, and the
+  uplink saving of VEML6030ChangeFilter plus the encoder on a simulated day of
+  light.
+
+  1. Random samples (counts, conversion steps and timestamps, wrap included)
+     are packed into 48 byte blocks and unpacked again; every sample has to
+     come back unchanged. Every truncated block has to decode to a prefix of
+     its samples, never to a wrong one, and a varint longer than 32 bits
+     has to be refused.
+  2. The simulated sensor sees a slow light curve with 1% noise and is read
+     every second for 24 hours. The bytes of sending every readLight_A() value
+     (4 bytes each) are compared with the filtered, encoded stream.
+
+  Build and run from the repository root:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_Stream.cpp \
+        extras/host/Wire.cpp extras/host/VEML6030Sim.cpp extras/host/stream_roundtrip.cpp \
+        -o stream_roundtrip
+    ./stream_roundtrip
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_Stream.h"
+#include "VEML6030Sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const uint16_t BLOCK = 48;
+
+static uint32_t seed = 12345;
+static uint32_t nextRandom()
+{
+  seed = seed * 1664525 + 1013904223;
+  return seed;
+}
+
+static bool same(const VEML6030RawSample &a, const VEML6030RawSample &b)
+{
+  return a.timestamp == b.timestamp && a.raw == b.raw && a.convStep == b.convStep;
+}
+
+// Packs the samples into blocks and checks that each block decodes to what
+// went in, also when cut short. Returns the number of failures.
+static uint32_t roundTrip(const std::vector<VEML6030RawSample> &samples, uint32_t &blocks)
+{
+  uint8_t buffer[BLOCK];
+  VEML6030StreamEncoder encoder(buffer, sizeof(buffer));
+  uint32_t failures = 0;
+  size_t first = 0;
+  blocks = 0;
+
+  for (size_t i = 0; i <= samples.size(); i++) {
+    if (i < samples.size() && encoder.add(samples[i]))
+      continue;
+
+    // The block is complete: decode it in full and every prefix of it.
+    blocks++;
+    for (uint16_t length = 0; length <= encoder.size(); length++) {
+      VEML6030StreamDecoder decoder(encoder.data(), length);
+      VEML6030RawSample sample;
+      size_t n = 0;
+      while (decoder.next(sample)) {
+        if (first + n >= samples.size() || !same(sample, samples[first + n]))
+          failures++;
+        n++;
+      }
+      if (length == encoder.size() && (n != encoder.count() || decoder.error()))
+        failures++;
+    }
+
+    first = i;
+    encoder.reset();
+    if (i < samples.size() && !encoder.add(samples[i]))
+      failures++;
+  }
+  return failures;
+}
+
+int main()
+{
+  // 1. Random samples: mostly small steps, some jumps, some setting changes.
+  std::vector<VEML6030RawSample> samples;
+  VEML6030RawSample sample = { 0xFFFFF000, 1000, 3 };
+  for (uint32_t i = 0; i < 200000; i++) {
+    uint32_t r = nextRandom();
+    sample.timestamp += (r >> 28) == 0 ? (nextRandom() >> 8) : (r & 0x3FF);
+    int32_t raw = sample.raw + (((r >> 24) & 0xF) == 0 ? (int32_t)(nextRandom() & 0xFFFF) - sample.raw
+                                                      : (int32_t)((r >> 10) & 0x3F) - 32);
+    sample.raw = raw < 0 ? 0 : raw > 0xFFFF ? 0xFFFF : raw;
+    if ((r & 0x3FF) == 0)
+      sample.convStep = nextRandom() % 10;
+    samples.push_back(sample);
+  }
+  uint32_t blocks;
+  uint32_t failures = roundTrip(samples, blocks);
+  printf("Round trip of %u random samples in %u blocks: %s (%u failures)\n",
+         (unsigned)samples.size(), (unsigned)blocks, failures ? "FAILED" : "OK", (unsigned)failures);
+
+  // Samples without a valid conversion step are refused, at the start of a
+  // block and after it.
+  {
+    uint8_t buffer[BLOCK];
+    VEML6030StreamEncoder encoder(buffer, sizeof(buffer));
+    VEML6030RawSample invalid = { 0, 1000, 10 };
+    VEML6030RawSample unknown = { 0, 1000, VEML6030::CONV_STEP_INVALID };
+    uint32_t refused = !encoder.add(invalid) + !encoder.add(unknown);
+    encoder.add(samples[0]);
+    uint16_t size = encoder.size();
+    refused += !encoder.add(invalid) + !encoder.add(unknown);
+    bool ok = refused == 4 && encoder.size() == size && encoder.count() == 1;
+    if (!ok)
+      failures++;
+    printf("Samples without a conversion step: %s\n", ok ? "refused" : "FAILED");
+  }
+
+  // A varint whose fifth byte carries more than the 4 bits left of 32 is a
+  // corrupt block, not a timestamp with its top bits cut off.
+  {
+    const uint8_t largest[] = { 3, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x10 };
+    const uint8_t tooLong[] = { 3, 0x80, 0x80, 0x80, 0x80, 0x10, 0x10 };
+    VEML6030StreamDecoder good(largest, sizeof(largest));
+    VEML6030StreamDecoder bad(tooLong, sizeof(tooLong));
+    VEML6030RawSample decoded;
+    bool ok = good.next(decoded) && decoded.timestamp == 0xFFFFFFFF && decoded.raw == 0x10 &&
+              !bad.next(decoded) && bad.error();
+    if (!ok)
+      failures++;
+    printf("Varint longer than 32 bits: %s\n", ok ? "refused" : "FAILED");
+  }
+
+  // 2. A day of light read once a second.
+  VEML6030Sim sim;
+  Wire.attach(0x48, &sim);
+  sim.setScene([](uint64_t us) {
+    double hours = us / 3600e6;
+    double daylight = sin((hours - 6) * M_PI / 12);
+    double lux = daylight > 0 ? 20 + 800 * daylight : 20;
+    return lux * (1 + 0.01 * ((int32_t)(nextRandom() >> 16) - 32768) / 32768.0);
+  });
+
+  SparkFun_Ambient_Light_A light(0x48);
+  light.begin();
+  light.enableShadowCache();
+  light.setGain(.125);
+  light.setIntegTime(100);
+
+  VEML6030ChangeFilter filter(500, 20, 600000); // 0.5 lux or 2%, at least every 10 minutes
+  uint8_t buffer[BLOCK];
+  VEML6030StreamEncoder encoder(buffer, sizeof(buffer));
+  std::vector<VEML6030RawSample> sent;
+  uint32_t reads = 0, plainBytes = 0, streamBytes = 0, packets = 0;
+
+  for (uint32_t second = 0; second < 24 * 3600; second++) {
+    delay(1000);
+    reads++;
+    plainBytes += 4;
+    if (!filter.update(light, millis()))
+      continue;
+    sent.push_back(filter.last());
+    if (!encoder.add(filter.last())) {
+      streamBytes += encoder.size();
+      packets++;
+      encoder.reset();
+      encoder.add(filter.last());
+    }
+  }
+  streamBytes += encoder.size();
+  packets++;
+
+  failures += roundTrip(sent, blocks);
+  printf("24h at 1 Hz: %u readings, %u passed the filter\n", (unsigned)reads, (unsigned)sent.size());
+  printf("  every readLight_A() value: %u bytes\n", (unsigned)plainBytes);
+  printf("  filtered and encoded:      %u bytes in %u packets (%.1fx smaller), round trip %s\n",
+         (unsigned)streamBytes, (unsigned)packets, (double)plainBytes / streamBytes,
+         failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+/*
+  Prints the I2C cost of every public SparkFun_Ambient_Light_A call against the
+  simulated sensor: transactions, bytes on the wire and bus time at 400kHz,
+  with the shadow register cache off and on. Build and run from the
+  repository root with:
+
+    g++ -std=gnu++11 -O2 -Iextras/host -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp extras/host/Wire.cpp \
+        extras/host/VEML6030Sim.cpp extras/host/transaction_report.cpp -o transaction_report
+    ./transaction_report
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "VEML6030Sim.h"
+#include <stdio.h>
+
+static VEML6030Sim sim;
+static SparkFun_Ambient_Light_A light(0x48);
+
+static void report(const char *name, void (*call)())
+{
+  Wire.resetStats();
+  call();
+  const TwoWireStats &s = Wire.stats();
+  printf("  %-22s %3u transactions %4u bytes %6.1f us\n", name, (unsigned)s.transactions,
+         (unsigned)(s.bytesWritten + s.bytesRead), (double)s.busTimeUs);
+}
+
+static void runAll()
+{
+  report("begin", [] { light.begin(); });
+  report("setGain", [] { light.setGain(.125); });
+  report("readGain", [] { light.readGain(); });
+  report("setIntegTime", [] { light.setIntegTime(100); });
+  report("readIntegTime", [] { light.readIntegTime(); });
+  report("setProtect", [] { light.setProtect(2); });
+  report("readProtect", [] { light.readProtect(); });
+  report("enableInt", [] { light.enableInt(); });
+  report("readIntSetting", [] { light.readIntSetting(); });
+  report("setIntLowThresh", [] { light.setIntLowThresh(20); });
+  report("readLowThresh", [] { light.readLowThresh(); });
+  report("setIntHighThresh", [] { light.setIntHighThresh(400); });
+  report("readHighThresh", [] { light.readHighThresh(); });
+  report("setPowSavMode", [] { light.setPowSavMode(2); });
+  report("readPowSavMode", [] { light.readPowSavMode(); });
+  report("enablePowSave", [] { light.enablePowSave(); });
+  report("disablePowSave", [] { light.disablePowSave(); });
+  report("setPowSave", [] { light.setPowSave(3); });
+  report("readInterrupt", [] { light.readInterrupt(); });
+  report("readLight_A", [] { light.readLight_A(); });
+  report("readLightMilliLux", [] { light.readLightMilliLux(); });
+  report("readWhiteLight", [] { light.readWhiteLight(); });
+  report("readSnapshot", [] { VEML6030Snapshot snapshot; light.readSnapshot(snapshot); });
+  report("applyConfig", [] { VEML6030Config config; light.applyConfig(config); });
+  report("shutDown", [] { light.shutDown(); });
+  report("powerOn", [] { light.powerOn(); });
+}
+
+int main()
+{
+  Wire.setClock(400000);
+  Wire.attach(0x48, &sim);
+  sim.setLux(250);
+
+  printf("Shadow register cache off:\n");
+  runAll();
+
+  light.enableShadowCache();
+  printf("Shadow register cache on:\n");
+  runAll();
+
+  // One NACK on a read, recovered by a retry.
+  light.setRetryPolicy(2);
+  light.resetBusStats();
+  sim.failNext(1);
+  printf("One NACK, two retries allowed:\n");
+  report("readLight_A", [] { uint32_t luxVal; light.readLight_A(luxVal); });
+  const VEML6030BusStats &bus = light.busStats();
+  printf("  status %d, %u nacks, %u retries, %u failures\n", light.lastStatus(),
+         (unsigned)bus.nacks, (unsigned)bus.retries, (unsigned)bus.failures);
+
+  // A NACK on the settings write in begin() leaves the conversion step
+  // unknown; the first conversion reads SETTING_REG again.
+  static SparkFun_Ambient_Light_A glitched(0x48);
+  sim.failNext(1);
+  glitched.begin();
+  printf("One NACK in begin(), no retries:\n");
+  report("readLight_A", [] { glitched.readLight_A(); });
+  report("readLight_A again", [] { glitched.readLight_A(); });
+  printf("  conversion step %u\n", glitched.readConvStep());
+
+  // A NACK while filling the shadow cache leaves it off, so setters still
+  // read the sensor rather than building on zeros.
+  glitched.setIntegTime(400);
+  sim.failNext(1);
+  VEML6030_STATUS cacheStatus = glitched.enableShadowCache();
+  printf("One NACK in enableShadowCache(), no retries: status %d\n", cacheStatus);
+  report("setGain", [] { glitched.setGain(.25); });
+  printf("  gain %.2f, integration time %u ms\n", glitched.readGain(), glitched.readIntegTime());
+
+  return 0;
+}
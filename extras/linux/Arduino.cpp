@@ -0,0 +1,35 @@
+/*
+  Clock functions and the Wire object for Linux boards, see Arduino.h and
+  Wire.h.
+ */
+
+#include "Wire.h"
+#include <time.h>
+
+static uint64_t nowUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startUs = nowUs();
+
+unsigned long micros() { return (unsigned long)(nowUs() - startUs); }
+unsigned long millis() { return (unsigned long)((nowUs() - startUs) / 1000); }
+
+void delayMicroseconds(unsigned int us)
+{
+  struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+  while (nanosleep(&ts, &ts) != 0)
+    ;
+}
+
+void delay(unsigned long ms)
+{
+  struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+  while (nanosleep(&ts, &ts) != 0)
+    ;
+}
+
+TwoWire Wire;
@@ -0,0 +1,19 @@
+/*
+  Stand-in for the parts of Arduino.h used by the library when it runs on a
+  Linux board through VEML6030LinuxI2C. Time is the system's monotonic clock.
+ */
+
+#ifndef _VEML6030_LINUX_ARDUINO_H_
+#define _VEML6030_LINUX_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Time since the first call, like on a board after reset.
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+#endif
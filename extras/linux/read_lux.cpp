@@ -0,0 +1,53 @@
+/*
+  Reads a VEML6030 on a Linux I2C adapter once a second.
+
+  Build from the repository root and run with the bus number and, optionally,
+  the sensor's address (0x48 or 0x10):
+
+    g++ -std=gnu++11 -O2 -Iextras/linux -Isrc \
+        src/SparkFun_VEML6030_Ambient_Light_Sensor_A.cpp src/SparkFun_VEML6030_LinuxI2C.cpp \
+        extras/linux/Arduino.cpp extras/linux/read_lux.cpp -o read_lux
+    ./read_lux 1 0x48
+ */
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_LinuxI2C.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <bus number> [address]\n", argv[0]);
+    return 2;
+  }
+  uint8_t bus = (uint8_t)strtoul(argv[1], NULL, 0);
+  uint8_t address = (argc > 2) ? (uint8_t)strtoul(argv[2], NULL, 0) : VEML6030::DEFAULT_ADDRESS;
+
+  VEML6030LinuxI2C transport(address);
+  if (!transport.open(bus)) {
+    fprintf(stderr, "/dev/i2c-%u: %s\n", bus, strerror(errno));
+    return 1;
+  }
+  transport.setRetryPolicy(2, 5000);
+
+  SparkFun_Ambient_Light_A light(address);
+  if (!light.begin(transport)) {
+    fprintf(stderr, "No VEML6030 at 0x%02X\n", address);
+    return 1;
+  }
+  light.setGain(.125);
+  light.setIntegTime(100);
+
+  for (;;) {
+    delay(1000);
+    uint32_t luxVal;
+    if (light.readLight_A(luxVal) == VEML6030_OK)
+      printf("%u lux\n", (unsigned)luxVal);
+    else
+      printf("read failed, %u failures so far\n", (unsigned)light.busStats().failures);
+    fflush(stdout);
+  }
+}
@@ -0,0 +1,204 @@
+#!/bin/sh
+#
+# Flash and RAM cost of each feature of the SparkFun VEML6030 library, in the
+# default build and with VEML6030_FOOTPRINT_OPTIMIZED.
+#
+# Builds one small sketch per feature with arduino-cli, once as is and once
+# with the footprint optimized profile, and prints what the compiler reports
+# for program storage and global variables, plus the difference to a sketch
+# that only starts Wire. Each sketch keeps its results in a volatile, so the
+# optimizer cannot drop the calls it measures.
+#
+# Usage, from anywhere:
+#
+#   extras/size_report/size_report.sh [fqbn]
+#
+# The board defaults to arduino:avr:uno; its core has to be installed
+# (arduino-cli core install arduino:avr). Set ARDUINO_CLI to use another
+# arduino-cli binary.
+
+set -e
+
+FQBN=${1:-arduino:avr:uno}
+CLI=${ARDUINO_CLI:-arduino-cli}
+LIB=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FEATURES=""
+
+# feature NAME: the sketch body for NAME is read from stdin. The library
+# header is included for every feature except the baseline.
+feature()
+{
+  mkdir -p "$WORK/$1"
+  {
+    echo '#include <Wire.h>'
+    [ "$1" = baseline ] || echo '#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"'
+    cat
+  } > "$WORK/$1/$1.ino"
+  FEATURES="$FEATURES $1"
+}
+
+feature baseline <<'EOF'
+void setup(){ Wire.begin(); }
+void loop(){}
+EOF
+
+feature include_only <<'EOF'
+void setup(){ Wire.begin(); }
+void loop(){}
+EOF
+
+feature begin <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile bool ok;
+void setup(){ Wire.begin(); ok = light.begin(); }
+void loop(){}
+EOF
+
+feature readLight_A <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); }
+void loop(){ sink = light.readLight_A(); }
+EOF
+
+feature readLightMilliLux <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); }
+void loop(){ sink = light.readLightMilliLux(); }
+EOF
+
+# The same settings as the fixed sketch below, so the two compare
+# VEML6030Fixed with the runtime class.
+feature gain_integ_time <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); light.setGain(.125); light.setIntegTime(100); }
+void loop(){ sink = light.readLight_A(); }
+EOF
+
+feature interrupt <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){
+  Wire.begin(); light.begin();
+  light.setIntLowThresh(20); light.setIntHighThresh(400); light.enableInt();
+}
+void loop(){ sink = light.readInterrupt(); }
+EOF
+
+feature power_save <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); light.setPowSavMode(2); light.enablePowSave(); }
+void loop(){ sink = light.readLight_A(); }
+EOF
+
+feature poll <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); light.startMeasurement(millis()); }
+void loop(){ if (light.poll(millis())) sink = light.takeSample(); }
+EOF
+
+feature auto_range <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); light.enableAutoRange(); }
+void loop(){ sink = light.readLight_A(); }
+EOF
+
+feature event_mode <<'EOF'
+SparkFun_Ambient_Light_A light(0x48);
+volatile uint32_t sink;
+void changed(uint32_t luxVal, uint8_t direction){ sink = luxVal + direction; }
+void setup(){ Wire.begin(); light.begin(); light.onLightChange(changed); light.enableEventMode(10, true); }
+void loop(){ light.serviceEvents(); }
+EOF
+
+feature fixed <<'EOF'
+#include "SparkFun_VEML6030_Fixed.h"
+VEML6030Fixed<VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms100> light(0x48);
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); }
+void loop(){ sink = light.readLight_A(); }
+EOF
+
+feature hdr <<'EOF'
+#include "SparkFun_VEML6030_HDR.h"
+SparkFun_Ambient_Light_A light(0x48);
+VEML6030HDR hdr(light);
+volatile uint32_t sink;
+void setup(){
+  Wire.begin(); light.begin(); light.enableShadowCache();
+  hdr.begin(VEML6030::Gain::X2, VEML6030::IntegTime::Ms100,
+            VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms25, millis());
+}
+void loop(){ if (hdr.poll(millis())) sink = hdr.milliLux(); }
+EOF
+
+feature power_control <<'EOF'
+#include "SparkFun_VEML6030_PowerControl.h"
+SparkFun_Ambient_Light_A light(0x48);
+VEML6030PowerController power(light);
+VEML6030PowerPolicy policy;
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); light.enableShadowCache(); power.begin(policy, millis()); }
+void loop(){ if (power.poll(millis())) sink = power.milliLux(); }
+EOF
+
+feature stream <<'EOF'
+#include "SparkFun_VEML6030_Stream.h"
+SparkFun_Ambient_Light_A light(0x48);
+VEML6030ChangeFilter filter(1000, 50, 60000);
+uint8_t block[32];
+VEML6030StreamEncoder encoder(block, sizeof(block));
+volatile uint32_t sink;
+void setup(){ Wire.begin(); light.begin(); }
+void loop(){
+  if (filter.update(light, millis()) && !encoder.add(filter.last())) {
+    sink = encoder.size();
+    encoder.reset();
+  }
+}
+EOF
+
+# build NAME PROFILE [extra flags]: prints "flash ram" for one sketch.
+build()
+{
+  name=$1
+  profile=$2
+  shift 2
+  out=$("$CLI" compile --fqbn "$FQBN" --library "$LIB" --build-path "$WORK/build/$profile/$name" \
+        ${1:+--build-property "compiler.cpp.extra_flags=$1"} "$WORK/$name" 2>&1) || {
+    echo "$name ($profile) failed to build:" >&2
+    echo "$out" >&2
+    exit 1
+  }
+  flash=$(echo "$out" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  ram=$(echo "$out" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+  echo "${flash:-0} ${ram:-0}"
+}
+
+echo "Flash and RAM in bytes on $FQBN; + is over the baseline sketch (Wire only)"
+echo
+printf '%-18s %19s %19s %19s\n' "" "default" "footprint optimized" "saved"
+printf '%-18s %9s %9s %9s %9s %9s %9s\n' feature flash ram flash ram flash ram
+
+for name in $FEATURES; do
+  set -- $(build "$name" default)
+  flash=$1 ram=$2
+  set -- $(build "$name" optimized -DVEML6030_FOOTPRINT_OPTIMIZED)
+  optFlash=$1 optRam=$2
+  if [ "$name" = baseline ]; then
+    baseFlash=$flash baseRam=$ram
+    printf '%-18s %9s %9s %9s %9s\n' "$name" "$flash" "$ram" "$optFlash" "$optRam"
+  else
+    printf '%-18s %+9d %+9d %+9d %+9d %9d %9d\n' "$name" \
+      $((flash - baseFlash)) $((ram - baseRam)) $((optFlash - baseFlash)) $((optRam - baseRam)) \
+      $((flash - optFlash)) $((ram - optRam))
+  fi
+done
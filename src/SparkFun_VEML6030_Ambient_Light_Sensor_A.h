@@ -4,6 +4,23 @@
 #include <Wire.h>
 #include <Arduino.h>
 
+// Footprint optimized build: define VEML6030_FOOTPRINT_OPTIMIZED for the
+// whole build (with the board's build flags, e.g. compiler.cpp.extra_flags,
+// not in the sketch, which would only change what the sketch sees). Light
+// values are then converted with integer math only, so pow() and its floating
+// point library are not linked, and the header leaves out the generic macros
+// below, the global address constants and the six float conversion tables.
+// Use the names in namespace VEML6030 instead: they exist in both builds.
+// extras/size_report measures what each feature costs in either build.
+//
+// Settings writes: the datasheet does not say whether writing the gain,
+// integration time or power save mode restarts the conversion in progress, so
+// every wait after such a write (VEML6030::settleTimeMs()) lets the conversion
+// running under the old settings end first. Define
+// VEML6030_WRITE_RESTARTS_CONVERSION for the whole build to wait only for one
+// integration time under the new settings instead. That is how the simulator
+// in extras/host behaves; it has not been verified on the real sensor.
+#ifndef VEML6030_FOOTPRINT_OPTIMIZED
 #define ENABLE        0x01
 #define DISABLE       0x00
 #define SHUTDOWN      0x01
@@ -16,6 +33,7 @@
 // 7-Bit address options
 const uint8_t defAddr = 0x48;
 const uint8_t altAddr = 0x10;
+#endif
 
 enum VEML6030_16BIT_REGISTERS {
 
@@ -55,16 +73,296 @@ enum REGISTER_BIT_POSITIONS {
 
 };
 
+// Result of functions that talk to the sensor and can fail.
+enum VEML6030_STATUS {
+
+  VEML6030_OK            = 0x00,
+  VEML6030_INVALID_SETTING,
+  VEML6030_BUS_ERROR
+
+};
+
+// Result of begin() with an expected configuration. 
+enum VEML6030_START {
+
+  VEML6030_START_FAILED  = 0x00, // Invalid configuration or no answer
+  VEML6030_COLD_START,           // Registers had to be written
+  VEML6030_WARM_START            // Sensor was already configured, nothing written
+
+};
+
+#ifndef VEML6030_FOOTPRINT_OPTIMIZED
 // Table of lux conversion values depending on the integration time and gain. 
 // The arrays represent the all possible integration times and the index of the
 // arrays represent the register's gain settings, which is directly analgous to
-// their bit representations. 
+// their bit representations. The library itself no longer uses them: each
+// value is .0036 times a power of two, see VEML6030::rawToMilliLux(). 
 const float eightHIt[]     = {.0036, .0072, .0288, .0576};
 const float fourHIt[]      = {.0072, .0144, .0576, .1152};
 const float twoHIt[]       = {.0144, .0288, .1152, .2304};
 const float oneHIt[]       = {.0288, .0576, .2304, .4608};
 const float fiftyIt[]      = {.0576, .1152, .4608, .9216};
 const float twentyFiveIt[] = {.1152, .2304, .9216, 1.8432};
+#endif
+
+// Float-free lux conversion. Every gain and integration time combination has a
+// resolution of .0036 lux per count times a power of two, so the settings are
+// described by a conversion step from 0 (.0036, gain 2 at 800ms) to 9 (1.8432,
+// gain 1/8 at 25ms) and all math is done on integers. 
+namespace VEML6030 {
+
+  // 7-Bit address options
+  const uint8_t DEFAULT_ADDRESS = 0x48;
+  const uint8_t ALT_ADDRESS = 0x10;
+
+  // Values returned by readInterrupt() and handed to onLightChange()
+  // callbacks. The read functions return UNKNOWN for register bits that match
+  // no setting. 
+  enum Result : uint8_t {
+    INT_NONE  = 0x00,
+    INT_ABOVE = 0x01,
+    INT_BELOW = 0x02,
+    UNKNOWN   = 0xFF
+  };
+
+  // Values of the single bit fields written to the registers. 
+  enum BitValue : uint8_t {
+    BIT_DISABLE  = 0x00,
+    BIT_ENABLE   = 0x01,
+    BIT_POWER_ON = 0x00,
+    BIT_SHUTDOWN = 0x01
+  };
+
+  const uint8_t CONV_STEP_INVALID = 0xFF;
+
+  // Time the sensor needs after power up before it starts converting.
+  const uint8_t WAKE_TIME_MS = 4;
+
+  // This function turns a raw count into milli-lux without compensation. The
+  // result is the exact product floored to a whole milli-lux, e.g. one count at
+  // step 0 is 3 (3.6) milli-lux. Returns 0 for an invalid step.
+  uint32_t rawToMilliLux(uint16_t raw, uint8_t convStep);
+
+  // This function applies the datasheet's compensation polynomial to a
+  // milli-lux value using 64 bit fixed-point Horner evaluation. Compared with
+  // evaluating the polynomial exactly on the same input, the result is less than
+  // 1.5 milli-lux below and less than 0.03 milli-lux above it; this was checked
+  // for every count at every conversion step. Results that do not fit are
+  // saturated to 0xFFFFFFFF (about 4.29 million lux, reached from about 55163
+  // lux of uncompensated input).
+  uint32_t compensateMilliLux(uint32_t milliLux);
+
+  // This function applies the same polynomial to a whole lux value in 64 bit
+  // fixed point, like readLight_A() does above 1000 lux. The result is less
+  // than 0.001 lux below the exact polynomial, so it is the floating point
+  // result of the runtime class for all but 17 of the inputs up to the largest
+  // reading (120795 lux), where it is one lower. Larger inputs are clamped.
+  uint32_t compensateLux(uint32_t luxVal);
+
+  // This function turns a raw count into milli-lux like readLightMilliLux():
+  // rawToMilliLux() followed by compensateMilliLux() from 1001 lux up.
+  uint32_t convertMilliLux(uint16_t raw, uint8_t convStep);
+
+  // Gain and integration time settings, with their register bit values.
+  enum class Gain : uint8_t {
+    X1   = 0,
+    X2   = 1,
+    X1_8 = 2,
+    X1_4 = 3
+  };
+
+  enum class IntegTime : uint8_t {
+    Ms100 = 0,
+    Ms200 = 1,
+    Ms400 = 2,
+    Ms800 = 3,
+    Ms50  = 8,
+    Ms25  = 12
+  };
+
+  // This function returns the conversion step of a gain and integration time
+  // pair at compile time. 
+  constexpr uint8_t convStep(Gain gain, IntegTime time){
+    return (time == IntegTime::Ms800 ? 0 : time == IntegTime::Ms400 ? 1 :
+            time == IntegTime::Ms200 ? 2 : time == IntegTime::Ms100 ? 3 :
+            time == IntegTime::Ms50  ? 4 : 5) +
+           (gain == Gain::X2 ? 0 : gain == Gain::X1 ? 1 :
+            gain == Gain::X1_4 ? 3 : 4);
+  }
+
+  // This function returns the datasheet's refresh time in ms, the time from one
+  // new sample to the next, for an integration time and a power save mode
+  // (0 = off, 1 - 4). In power save mode the integration time is followed by a
+  // wait time of 500, 1000, 2000 or 4000ms, e.g. 100ms in mode 2 refreshes
+  // every 1100ms. 
+  constexpr uint16_t refreshTimeMs(IntegTime time, uint8_t psmMode){
+    return (time == IntegTime::Ms25  ? 25  : time == IntegTime::Ms50  ? 50 :
+            time == IntegTime::Ms100 ? 100 : time == IntegTime::Ms200 ? 200 :
+            time == IntegTime::Ms400 ? 400 : time == IntegTime::Ms800 ? 800 : 0) +
+           ((psmMode >= 1 && psmMode <= 4) ? (250 << psmMode) : 0);
+  }
+
+  // Margin added to every wait for a conversion: the caller's clock is whole
+  // milliseconds, read before the write that starts the wait, and the write
+  // itself takes a while on the bus.
+  const uint8_t SETTLE_GUARD_MS = 2;
+
+  // This function returns how long after a settings write (gain, integration
+  // time, power save mode or power up) the first sample converted wholly under
+  // the new settings can be read: the conversion running under the old
+  // settings, up to previousRefreshMs, then one integration time under the new
+  // ones, plus SETTLE_GUARD_MS. Pass 0 for a sensor that was shut down. With
+  // VEML6030_WRITE_RESTARTS_CONVERSION the old conversion is not waited for.
+#ifdef VEML6030_WRITE_RESTARTS_CONVERSION
+  constexpr uint32_t settleTimeMs(uint32_t, uint32_t integMs){
+    return integMs + SETTLE_GUARD_MS;
+  }
+#else
+  constexpr uint32_t settleTimeMs(uint32_t previousRefreshMs, uint32_t integMs){
+    return previousRefreshMs + integMs + SETTLE_GUARD_MS;
+  }
+#endif
+
+  // This function converts a raw count to lux like readLight_A() does at the
+  // given settings, compensation above 1000 lux included, without any sensor
+  // or bus. The compensation polynomial is evaluated with products instead of
+  // pow(); where double is 64 bits wide this gives readLight_A()'s result for
+  // every count. 
+  uint32_t rawToLux(uint16_t raw, Gain gain, IntegTime time);
+
+  // This function converts n raw counts taken at the same settings to lux,
+  // with results identical to rawToLux(). It is meant for re-converting logged
+  // data in bulk: the loop has no branches or library calls, so it can be
+  // vectorised by the compiler (checked with GCC at -O3). 
+  void convertRawToLux(const uint16_t *in, size_t n, Gain gain, IntegTime time, uint32_t *out);
+
+}
+
+// Counters kept per sensor by VEML6030Transport, to tell a flaky bus from a
+// missing sensor.
+struct VEML6030BusStats
+{
+  uint32_t transactions;   // Attempts, retries included
+  uint32_t nacks;          // Address or data not acknowledged
+  uint32_t shortReads;     // Fewer than two bytes returned
+  uint32_t retries;        // Attempts repeated after a failure
+  uint32_t failures;       // Transfers that failed after all retries
+  uint32_t worstLatencyUs; // Longest transfer, retries included
+};
+
+// The I2C transfers shared by SparkFun_Ambient_Light_A and VEML6030Fixed. It
+// knows nothing about the sensor's registers beyond their 16 bit little endian
+// layout. This base class does the retries and the bookkeeping; a backend
+// supplies single attempts of a register write and a register read, each as
+// one bus transaction. VEML6030WireTransport is the Arduino TwoWire backend,
+// VEML6030LinuxI2C (SparkFun_VEML6030_LinuxI2C.h) the Linux i2c-dev one.
+class VEML6030Transport
+{
+  public:
+
+    VEML6030Transport(uint8_t address);
+    virtual ~VEML6030Transport() {}
+
+    // This function returns the sensor's 7-bit address. 
+    uint8_t address() { return _address; }
+
+    // This function checks if the sensor acknowledges its address. 
+    virtual bool isConnected() = 0;
+
+    // This function sets how often a failed transfer is tried again, and the
+    // longest time in microseconds that may pass from the first attempt before a
+    // retry is started (0 for no limit). The default is no retries. 
+    void setRetryPolicy(uint8_t maxRetries, uint32_t budgetUs = 0);
+
+    // This function returns the bus health counters.
+    const VEML6030BusStats &busStats();
+
+    // This function zeroes the bus health counters.
+    void resetBusStats();
+
+    // This function writes a 16 bit value to a register in a single transaction,
+    // retrying as set by setRetryPolicy().
+    VEML6030_STATUS writeRegister(uint8_t _wReg, uint16_t _value);
+
+    // This function reads a 16 bit register into _value, retrying as set by
+    // setRetryPolicy(). _value is only changed on success.
+    VEML6030_STATUS readRegister(uint8_t _reg, uint16_t &_value);
+
+    // This function reads a 16 bit register. It takes the register's
+    // address as its' parameter. On a bus error it returns 0. 
+    uint16_t readRegister(uint8_t _reg);
+
+  protected:
+
+    // A single attempt at a register write or read. Backends count NACKs and
+    // short reads in _stats; attempts and everything else are counted here. 
+    virtual VEML6030_STATUS _writeOnce(uint8_t _wReg, uint16_t _value) = 0;
+    virtual VEML6030_STATUS _readOnce(uint8_t _reg, uint16_t &_value) = 0;
+
+    uint8_t _address;
+    VEML6030BusStats _stats;
+
+  private:
+
+    bool _retryAllowed(uint8_t _attempt, uint32_t _start);
+    void _finish(VEML6030_STATUS _status, uint32_t _start);
+
+    uint8_t _maxRetries;
+    uint32_t _retryBudgetUs;
+};
+
+// VEML6030Transport on an Arduino TwoWire port. 
+class VEML6030WireTransport : public VEML6030Transport
+{
+  public:
+
+    VEML6030WireTransport(uint8_t address);
+
+    // This function sets the I2C port used for all further transfers. 
+    void begin(TwoWire &wirePort);
+
+    // This function checks if the sensor acknowledges its address. 
+    bool isConnected();
+
+  protected:
+
+    VEML6030_STATUS _writeOnce(uint8_t _wReg, uint16_t _value);
+    VEML6030_STATUS _readOnce(uint8_t _reg, uint16_t &_value);
+
+  private:
+
+    TwoWire *_i2cPort;
+};
+
+// A complete sensor configuration that can be written in one go with
+// applyConfig(). The values use the same units as the individual setters.
+// The defaults match the sensor's power-on state, except that it is awake.
+struct VEML6030Config
+{
+  float gain;            // .125, .25, 1 or 2
+  uint16_t integTime;    // 25, 50, 100, 200, 400 or 800 ms
+  uint8_t protect;       // 1, 2, 4 or 8 values beyond a threshold
+  bool intEnabled;       // Interrupt on threshold crossing
+  uint32_t lowThresh;    // Lux, 0 - 120000
+  uint32_t highThresh;   // Lux, 0 - 120000
+  uint8_t powSavMode;    // 1 - 4
+  bool powSavEnabled;    // Power save mode on
+  bool shutDown;         // Leave the sensor powered down
+
+  VEML6030Config() : gain(1), integTime(100), protect(1), intEnabled(false),
+                     lowThresh(0), highThresh(0), powSavMode(1),
+                     powSavEnabled(false), shutDown(false) {}
+};
+
+// Everything readSnapshot() gets from the sensor in one call.
+struct VEML6030Snapshot
+{
+  uint16_t ambientRaw;   // REG0x04 counts
+  uint16_t whiteRaw;     // REG0x05 counts
+  uint8_t interrupt;     // VEML6030::INT_NONE, INT_ABOVE or INT_BELOW
+  uint32_t ambientLux;   // As readLight_A()
+  uint32_t whiteLux;     // As readWhiteLight()
+};
 
 class SparkFun_Ambient_Light_A
 {  
@@ -74,12 +372,30 @@ class SparkFun_Ambient_Light_A
 
     bool begin(TwoWire &wirePort = Wire); // begin function
 
+    // This function does the same as begin() above, but talks to the sensor
+    // through the given transport, e.g. a VEML6030LinuxI2C. The transport has
+    // to stay alive as long as this object uses it and brings its own address;
+    // the one given to the constructor is not used. 
+    bool begin(VEML6030Transport &transport);
+
+    // REG0x00 - REG0x03
+    // These functions start the sensor with the given configuration, for use
+    // after a reset of the microcontroller alone, when the sensor may still be
+    // set up. The four configuration registers are read once and only those
+    // that differ from the configuration are written; the power up wait is only
+    // done if the sensor was shut down. The reads also serve as the connection
+    // check. Returns VEML6030_WARM_START if nothing had to be written,
+    // VEML6030_COLD_START if something was, and VEML6030_START_FAILED (zero) if
+    // the configuration is invalid or the sensor does not answer. 
+    VEML6030_START begin(const VEML6030Config &expected, TwoWire &wirePort = Wire);
+    VEML6030_START begin(const VEML6030Config &expected, VEML6030Transport &transport);
+
     // REG0x00, bits [12:11]
     // This function sets the gain for the Ambient Light Sensor. Possible values
     // are 1/8, 1/4, 1, and 2. The highest setting should only be used if the
     // sensors is behind dark glass, where as the lowest setting should be used in
     // dark rooms. The datasheet suggests always leaving it at around 1/4 or 1/8.
-    void setGain(float gainVal);
+    VEML6030_STATUS setGain(float gainVal);
 
     // REG0x00, bits [12:11]
     // This function reads the gain for the Ambient Light Sensor. Possible values
@@ -92,7 +408,7 @@ class SparkFun_Ambient_Light_A
     // This function sets the integration time (the saturation time of light on the
     // sensor) of the ambient light sensor. Higher integration time leads to better
     // resolution but slower sensor refresh times. 
-    void setIntegTime(uint16_t time);
+    VEML6030_STATUS setIntegTime(uint16_t time);
 
     // REG0x00, bits[9:6]
     // This function reads the integration time (the saturation time of light on the
@@ -100,10 +416,16 @@ class SparkFun_Ambient_Light_A
     // resolution but slower sensor refresh times. 
     uint16_t readIntegTime();
 
+    // REG0x00, bits[12:11] and bits[9:6]
+    // This function sets the gain and the integration time together, with a
+    // single write of SETTING_REG, so the sensor never runs with a mix of the
+    // old and the new settings. 
+    VEML6030_STATUS setGainAndIntegTime(VEML6030::Gain gain, VEML6030::IntegTime time);
+
     // REG0x00, bits[5:4]
     // This function sets the persistence protect number i.e. the number of
     // values needing to crosh the interrupt thresholds.
-    void setProtect(uint8_t protVal);
+    VEML6030_STATUS setProtect(uint8_t protVal);
 
     // REG0x00, bits[5:4]
     // This function reads the persistence protect number i.e. the number of 
@@ -112,11 +434,11 @@ class SparkFun_Ambient_Light_A
 
     // REG0x00, bit[1]
     // This function enables the Ambient Light Sensor's interrupt. 
-    void enableInt();
+    VEML6030_STATUS enableInt();
 
     // REG0x00, bit[1]
     // This function disables the Ambient Light Sensor's interrupt. 
-    void disableInt();
+    VEML6030_STATUS disableInt();
 
     // REG0x00, bit[1]
     // This function checks if the interrupt is enabled or disabled. 
@@ -126,24 +448,30 @@ class SparkFun_Ambient_Light_A
     // This function powers down the Ambient Light Sensor. The light sensor will
     // hold onto the last light reading which can be acessed while the sensor is 
     // shut down. 0.5 micro Amps are consumed while shutdown. 
-    void shutDown();
+    VEML6030_STATUS shutDown();
 
     // REG0x00, bit[0]
     // This function powers up the Ambient Light Sensor. The last value that was
     // read during shut down will be overwritten on the sensor's subsequent read.
     // After power up, a small 4ms delay is applied to give time for the internal
     // osciallator and signal processor to power up.   
-    void powerOn();
+    VEML6030_STATUS powerOn();
+
+    // REG0x00, bit[0]
+    // This function powers up the sensor like powerOn(), but returns right
+    // after the write instead of waiting. The caller has to leave the sensor
+    // VEML6030::WAKE_TIME_MS before relying on it. 
+    VEML6030_STATUS powerOnNoWait();
 
     // REG0x03, bit[0]
     // This function enables the current power save mode value and puts the Ambient
     // Light Sensor into power save mode. 
-    void enablePowSave();
+    VEML6030_STATUS enablePowSave();
 
     // REG0x03, bit[0]
     // This function disables the current power save mode value and pulls the Ambient
     // Light Sensor out of power save mode. 
-    void disablePowSave();
+    VEML6030_STATUS disablePowSave();
 
     // REG0x03, bit[0]
     // This function checks to see if power save mode is enabled or disabled. 
@@ -154,7 +482,7 @@ class SparkFun_Ambient_Light_A
     // incrementally higher value descreases the sampling rate of the sensor and so
     // increases power saving. The datasheet suggests enabling these modes when
     // continually sampling the sensor. 
-    void setPowSavMode(uint16_t modeVal);
+    VEML6030_STATUS setPowSavMode(uint16_t modeVal);
 
     // REG0x03, bit[2:1]
     // This function reads the power save mode value. The function above takes a value of 1-4. Each
@@ -163,16 +491,61 @@ class SparkFun_Ambient_Light_A
     // continually sampling the sensor. 
     uint8_t readPowSavMode();
 
+    // REG0x03, bits[2:0]
+    // This function sets the power save mode (1-4) and turns it on, or turns it
+    // off for 0, with a single write of POWER_SAVE_REG. A mode that is off
+    // keeps its value, as with disablePowSave(). 
+    VEML6030_STATUS setPowSave(uint8_t modeVal);
+
     // REG0x06, bits[15:14]
     // This function reads the interrupt register to see if an interrupt has been
     // triggered. There are two possible interrupts: a lower limit and upper limit 
     // threshold, both set by the user.  
     uint8_t readInterrupt();
 
+    // REG0x00 - REG0x02
+    // This function turns on event mode. The interrupt thresholds are set to a
+    // window around the current reading and moved to the new reading after each
+    // interrupt, so the sensor only interrupts when the light has changed by more
+    // than the band. The band is in lux, or in percent of the last reading if
+    // percentBand is true. The INT pin has to be connected and its interrupt
+    // routine has to call notifyInterrupt().
+    void enableEventMode(uint32_t band, bool percentBand = false);
+
+    // This function turns event mode off and disables the sensor's interrupt. 
+    void disableEventMode();
+
+    // This function sets a function to be called by serviceEvents() with the new
+    // lux value and VEML6030::INT_ABOVE or INT_BELOW whenever the light has
+    // left the window.
+    void onLightChange(void (*callback)(uint32_t luxVal, uint8_t direction));
+
+    // This function only records that the INT pin fired, it does not touch the
+    // bus. It is meant to be called from the pin's interrupt routine. 
+    void notifyInterrupt();
+
+    // This function handles an interrupt recorded by notifyInterrupt(). It reads
+    // and clears the interrupt register; unless that shows the light above or
+    // below the window, there is no event and nothing else is done. Otherwise
+    // it reads the new light level, moves the window to it (two single writes,
+    // in raw counts) and calls the callback. event tells if there was an event.
+    // Returns VEML6030_OK or VEML6030_BUS_ERROR; if moving the window failed the
+    // sensor interrupts again on its next reading outside the old one, and the
+    // next call tries again. Call it from loop(), not from the interrupt
+    // routine.
+    VEML6030_STATUS serviceEvents(bool &event);
+
+    // This function does the same, and returns true if there was an event. A
+    // failure is left in lastStatus().
+    bool serviceEvents();
+
+    // This function returns the lux value read by the last event. 
+    uint32_t readEventLux();
+
     // REG0x02, bits[15:0]
     // This function sets the lower limit for the Ambient Light Sensor's interrupt. 
     // It takes a lux value as its paramater.
-    void setIntLowThresh(uint32_t luxVal_A);
+    VEML6030_STATUS setIntLowThresh(uint32_t luxVal_A);
     
     // REG0x02, bits[15:0]
     // This function reads the lower limit for the Ambient Light Sensor's interrupt. 
@@ -181,7 +554,7 @@ class SparkFun_Ambient_Light_A
     // REG0x01, bits[15:0]
     // This function sets the upper limit for the Ambient Light Sensor's interrupt. 
     // It takes a lux value as its paramater.
-    void setIntHighThresh(uint32_t luxVal_A);
+    VEML6030_STATUS setIntHighThresh(uint32_t luxVal_A);
 
     // REG0x01, bits[15:0]
     // This function reads the upper limit for the Ambient Light Sensor's interrupt. 
@@ -199,21 +572,232 @@ class SparkFun_Ambient_Light_A
     // value exceeds 1000 then a compensation formula is applied to it. 
     uint32_t readWhiteLight();
 
+    // REG[0x04], bits[15:0]
+    // This function gets the sensor's ambient light value in milli-lux, using
+    // integer math only so it is cheap on parts without an FPU. The resolution
+    // of the sensor is kept, down to .0036 lux per count at the highest gain and
+    // longest integration time. From 1001 lux up the compensation formula is
+    // applied, like readLight_A(). 
+    uint32_t readLightMilliLux();
+
+    // REG[0x04] - REG[0x06]
+    // This function fills a snapshot with the ambient and white light, raw and in
+    // lux, and the interrupt status, reading each of the three registers once. The
+    // cached conversion value is used, so the configuration is only read (once)
+    // if it is not known yet. Note that reading the interrupt status clears it,
+    // like readInterrupt() does. Returns VEML6030_INVALID_SETTING if the sensor's
+    // gain or integration time bits are not valid.
+    VEML6030_STATUS readSnapshot(VEML6030Snapshot &snapshot);
+
+    // REG[0x04], bits[15:0]
+    // This function returns the raw ambient light count without converting it.
+    // Together with readConvStep() it is all that is needed to convert the value
+    // later, e.g. with VEML6030::convertMilliLux().
+    uint16_t readLightRaw();
+
+    // These functions are the status returning versions of the light reads. The
+    // value is only written on success. 
+    VEML6030_STATUS readLight_A(uint32_t &luxVal);
+    VEML6030_STATUS readWhiteLight(uint32_t &luxVal);
+    VEML6030_STATUS readLightMilliLux(uint32_t &milliLux);
+    VEML6030_STATUS readLightRaw(uint16_t &lightBits);
+    VEML6030_STATUS readInterrupt(uint8_t &intVal);
+
+    // This function returns the status of the last transfer with the sensor, so
+    // the value returning functions can be checked after the fact. Reads served
+    // from the shadow cache do not change it. 
+    VEML6030_STATUS lastStatus();
+
+    // This function sets the retry policy of the I2C transfers, see
+    // VEML6030Transport::setRetryPolicy(). 
+    void setRetryPolicy(uint8_t maxRetries, uint32_t budgetUs = 0);
+
+    // This function returns the bus health counters of this sensor: transfers,
+    // NACKs, short reads, retries, failed transfers and the worst transfer time.
+    const VEML6030BusStats &busStats();
+
+    // This function zeroes the bus health counters.
+    void resetBusStats();
+
+    // This function returns the conversion step of the current gain and
+    // integration time (see VEML6030::rawToMilliLux). It only touches the bus
+    // while the step is not known, see _knownConvStep().
+    uint8_t readConvStep();
+
+    // REG0x00 - REG0x03
+    // This function brings the sensor into the state described by the given
+    // configuration. Every value is checked before anything is written; then
+    // the threshold registers, POWER_SAVE_REG and SETTING_REG are each written
+    // exactly once, without reading them first. Returns VEML6030_OK,
+    // VEML6030_INVALID_SETTING (nothing written) or VEML6030_BUS_ERROR. 
+    VEML6030_STATUS applyConfig(const VEML6030Config &config);
+
+    // The following functions read the sensor without blocking. All times are in
+    // milliseconds from a clock supplied by the caller, usually millis(). 
+    // startMeasurement() powers the sensor up and works out when the first fresh
+    // sample will exist: the wake up time and one integration time for a sensor
+    // that was shut down, otherwise VEML6030::settleTimeMs() of the current
+    // settings, as the conversion in progress may have started before now.
+    // Returns the status of the bus transfers; the measurement is started either
+    // way, so calling it again after a failure is enough to retry.
+    VEML6030_STATUS startMeasurement(uint32_t now);
+
+    // This function advances the measurement. Once a new sample is due it reads the
+    // ambient light register. If the read fails it returns false and tries again
+    // SETTLE_GUARD_MS later, with the error in lastStatus(). If the gain,
+    // integration time or power save mode was changed since the last call, the
+    // wait starts over (see VEML6030::settleTimeMs()) so no sample from the old
+    // settings is reported. Returns true when a sample is ready.
+    bool poll(uint32_t now);
+
+    // This function returns the time between two fresh samples for the current
+    // settings: the integration time plus, in power save mode, the wait time of the
+    // selected mode (500, 1000, 2000 or 4000ms). See VEML6030::refreshTimeMs().
+    uint32_t refreshPeriodMs();
+
+    // This function returns the time from which a read can return a new sample:
+    // the time poll() reads next while a measurement runs, otherwise (with
+    // duplicate suppression on) one refresh period after the last bus read, in
+    // millis(). Returns the current millis() if a new sample may already exist. 
+    uint32_t nextSampleDueAt();
+
+    // This function does the same on the caller's clock, the one given to
+    // startMeasurement() and poll(): the time poll() reads next while a
+    // measurement waits, otherwise now, as poll() has to work it out first.
+    // Duplicate suppression is not looked at, as it runs on millis(). 
+    uint32_t nextSampleDueAt(uint32_t now);
+
+    // These functions turn duplicate suppression on and off. While it is on,
+    // readLight_A(), readLightMilliLux() and readLightRaw() only read the sensor
+    // once per refresh period; in between they return the last value read
+    // without touching the bus. Any sample read after a refresh period has
+    // passed is a new conversion. Changing the gain, integration time or power
+    // save mode through this library makes the next read go to the bus. 
+    void enableDuplicateSuppression();
+    void disableDuplicateSuppression();
+
+    // This function checks if poll() has a sample waiting to be taken. 
+    bool isSampleReady();
+
+    // This function returns the waiting sample in lux, with the same compensation
+    // as readLight_A(), and schedules the next one one refresh period after the
+    // last due time, so the reads stay in step with the sensor's conversions. A
+    // read that was late by a refresh period or more may already have returned a
+    // later conversion; the due time then moves on to the first one after the
+    // read, so no conversion is returned twice. It does not touch the bus. 
+    uint32_t takeSample();
+
+    // This function does the same as takeSample() but returns the raw count,
+    // which converts with readConvStep() like a VEML6030RawSample. 
+    uint16_t takeSampleRaw();
+
+    // REG0x00, bits[12:11] and bits[9:6]
+    // This function turns on the auto-range mode used by poll(). Each new sample
+    // is checked against two bands: counts at or above 0xE000 step to the next
+    // coarser setting, counts below targetCounts step to the finest setting that
+    // reaches targetCounts without being predicted to saturate. The first sample
+    // after a change is discarded. A higher targetCounts gives finer relative
+    // resolution at the cost of longer integration times. Ranging starts from
+    // gain 1/4 at 25ms; if that write fails the mode stays off. Returns
+    // VEML6030_OK, VEML6030_INVALID_SETTING or VEML6030_BUS_ERROR.
+    VEML6030_STATUS enableAutoRange(uint16_t targetCounts = 1000);
+
+    // This function turns off the auto-range mode. The gain and integration time
+    // stay at whatever the auto-range mode last picked. 
+    void disableAutoRange();
+
+    // This function turns on the shadow register cache. The SETTING_REG,
+    // H_THRESH_REG, L_THRESH_REG and POWER_SAVE_REG values are read once from
+    // the sensor and kept in RAM. Afterwards every setter is a single write and
+    // the matching read functions never touch the I2C bus. If a read fails the
+    // cache is not turned on and the bus error is returned. 
+    VEML6030_STATUS enableShadowCache();
+
+    // This function turns off the shadow register cache. Every read goes to the
+    // sensor again and every setter does a read-modify-write. 
+    void disableShadowCache();
+
+    // This function reloads the shadow register cache from the sensor. Call it
+    // if the sensor may have been reset or re-configured by something other
+    // than this library, e.g. after a power cycle of the sensor alone. If any
+    // read fails the cache and the conversion factor are left as they were and
+    // the bus error is returned. 
+    VEML6030_STATUS resyncFromDevice();
+
   private:
 
-    uint8_t _address_A;
+    VEML6030WireTransport _wire; // Used by begin(TwoWire&)
+    VEML6030Transport *_bus;     // The transport in use
+
+    // Shadow copies of the four writable registers, indexed by register
+    // address (SETTING_REG through POWER_SAVE_REG). Only used while
+    // _shadowEnabled is set.
+    bool _shadowEnabled;
+    uint16_t _shadowRegs[POWER_SAVE_REG + 1];
+
+    // Conversion step of the current gain and integration time (see
+    // VEML6030::rawToMilliLux). Refreshed every time SETTING_REG is written or
+    // re-read so conversions need no bus traffic. VEML6030::CONV_STEP_INVALID
+    // when the settings are unknown or invalid.
+    uint8_t _convStep;
+
+    // State of the non-blocking measurement started by startMeasurement().
+    enum { MEAS_IDLE, MEAS_WAITING, MEAS_READY, MEAS_RESTART };
+    uint8_t _measState;
+    VEML6030_STATUS _lastStatus; // Outcome of the last bus transfer
+    uint16_t _sampleBits;
+    uint32_t _sampleDueAt;
+    uint32_t _sampleReadAt;
+    uint32_t _refreshMs;
+
+    // Duplicate suppression state. _dupValid is cleared by any settings write.
+    bool _dupSuppress;
+    bool _dupValid;
+    uint16_t _dupBits;
+    uint32_t _dupDueAt;
+    uint32_t _dupPeriodMs;
+
+    // Auto-range state, _autoRangeTarget is zero while the mode is off.
+    uint16_t _autoRangeTarget;
+    uint8_t _autoRangeStep;
+
+    // Event mode state, _eventBand is zero while the mode is off. 
+    // _eventPending is set from an interrupt routine.
+    uint32_t _eventBand;
+    bool _eventPercent;
+    volatile bool _eventPending;
+    void (*_eventCallback)(uint32_t luxVal, uint8_t direction);
+    uint32_t _eventLux;
     
+    // This function reads the ambient light register, or returns the last value
+    // read if duplicate suppression is on and no new sample can exist yet. 
+    VEML6030_STATUS _readAmbient(uint16_t &_lightBits);
+
+    // This function turns a raw count into lux with the current settings and
+    // applies the compensation formula above 1000 lux. 
+    uint32_t _bitsToLux(uint16_t _lightBits);
+
+    // This function writes the event window around a raw count straight into the
+    // threshold registers, without converting to lux and back. 
+    VEML6030_STATUS _rearmEventWindow(uint16_t _lightBits);
+
+    // This function picks the next auto-range step for a raw count and writes it
+    // if it differs from the current one. Returns true if the settings changed.
+    bool _autoRange(uint16_t _lightBits);
+
+    // This function writes the gain and integration time of the current
+    // auto-range step with a single SETTING_REG update.
+    VEML6030_STATUS _writeAutoRangeStep(uint8_t _step);
+
     // This function compensates for lux values over 1000. From datasheet:
     // "Illumination values higher than 1000 lx show non-linearity. This
     // non-linearity is the same for all sensors, so a compensation forumla..."
-    // etc. etc. 
+    // etc. etc. The footprint optimized build evaluates it in fixed point. 
     uint32_t _luxCompensation(uint32_t _luxVal_A);
 
     // The lux value of the Ambient Light sensor depends on both the gain and the
-    // integration time settings. This function determines which conversion value
-    // to use by using the bit representation of the gain as an index to look up
-    // the conversion value in the correct integration time array. It then converts 
-    // the value and returns it.  
+    // integration time settings, which are kept as the conversion step (see
+    // _updateLuxConv) so this only needs to multiply. 
     uint32_t _calculateLux(uint16_t _lightBits);
 
     // This function does the opposite calculation then the function above. The interrupt
@@ -223,15 +807,59 @@ class SparkFun_Ambient_Light_A
     // that.  
     uint16_t _calculateBits(uint32_t _luxVal_A);
 
+    // This function returns the conversion step (see VEML6030::rawToMilliLux)
+    // for the given gain and integration time register bits, or
+    // VEML6030::CONV_STEP_INVALID for reserved bit patterns.
+    static uint8_t _lookupConvStep(uint8_t _gainBits, uint8_t _integBits);
+
+    // This function returns the cached conversion step. While it is not known,
+    // e.g. because the write in begin() failed on a bus glitch, SETTING_REG is
+    // read again on every call, so the conversions recover once the bus does.
+    uint8_t _knownConvStep();
+
+    // This function reads the four configuration registers from the sensor and,
+    // only if every read succeeds, stores them in the shadow cache and updates
+    // the conversion factor. Otherwise both are left unchanged and the bus error
+    // is returned. 
+    VEML6030_STATUS _fillShadow();
+
+    // This function refreshes the cached conversion step from a SETTING_REG
+    // value. It is called whenever the library writes or re-reads SETTING_REG.
+    void _updateLuxConv(uint16_t _settingReg);
+
+    // This function returns the refresh period like refreshPeriodMs() and gives
+    // the integration time alone, from the same register reads.
+    uint32_t _refreshPeriodMs(uint32_t &_integMs);
+
     // This function writes to a 16 bit register. Paramaters include the register's address, a mask 
     // for bits that are ignored, the bits to write, and the bits' starting
     // position.
-    void _writeRegister(uint8_t _wReg, uint16_t _mask, uint16_t _bits, uint8_t _startPosition);
+    VEML6030_STATUS _writeRegister(uint8_t _wReg, uint16_t _mask, uint16_t _bits, uint8_t _startPosition);
+
+    // This function writes a full 16 bit value to a register without reading it
+    // first. Once the write has succeeded the shadow cache and the lux conversion
+    // value are brought up to date.
+    VEML6030_STATUS _writeRaw(uint8_t _wReg, uint16_t _value);
+
+    // This function works out the register values of a configuration, indexed
+    // by register address. Returns VEML6030_INVALID_SETTING for values the
+    // sensor does not support. 
+    static VEML6030_STATUS _configToRegs(const VEML6030Config &_config, uint16_t *_regs);
+
+    // The following functions turn the user facing gain, integration time,
+    // persistence protect and power save mode values into their register bits.
+    // They return false for values the sensor does not support.
+    static bool _gainToBits(float _gainVal, uint16_t &_bits);
+    static bool _integTimeToBits(uint16_t _time, uint16_t &_bits);
+    static bool _protectToBits(uint8_t _protVal, uint16_t &_bits);
+    static bool _powSavModeToBits(uint16_t _modeVal, uint16_t &_bits);
 
     // This function reads a 16 bit register. It takes the register's
-    // address as its' parameter.
+    // address as its' parameter. On a bus error it returns 0; lastStatus() tells
+    // the two apart.
     uint16_t _readRegister(uint8_t _reg);
 
-    TwoWire *_i2cPort;
+    // This function reads a 16 bit register into _value and returns the status. 
+    VEML6030_STATUS _readRegister(uint8_t _reg, uint16_t &_value);
 };
 #endif
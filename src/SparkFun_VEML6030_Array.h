@@ -0,0 +1,154 @@
+#ifndef _SPARKFUN_VEML6030_ARRAY_H_
+#define _SPARKFUN_VEML6030_ARRAY_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+// A group of up to N sensors, on any mix of addresses and I2C ports, sampled
+// as one. start() shuts every sensor down and powers them back up one after
+// the other, spread evenly over one refresh period, so their conversions (and
+// with them the bus reads) are interleaved instead of all landing at once.
+// poll() then collects one sample from each sensor into a frame. Every entry of
+// a frame comes from a different conversion slot within the same refresh
+// period, so the time skew within a frame is below one refresh period.
+//
+// The sensors are not owned by the array: construct them as usual, call their
+// begin() with the right port and settings, then add() them. Nothing is
+// allocated at run time.
+template <uint8_t N>
+class VEML6030Array
+{
+    static_assert(N >= 1 && N <= 32, "VEML6030Array holds 1 to 32 sensors");
+
+  public:
+
+    struct Frame {
+      uint32_t lux[N];        // Same units as readLight_A()
+      uint32_t timestamp[N];  // Time each sample was read, from the clock given to poll()
+      uint32_t skew;          // Newest minus oldest timestamp
+      uint32_t sequence;      // Counts up with every completed frame
+    };
+
+    VEML6030Array() : _count(0), _period(0), _pending(0), _received(0) {
+      _frame.sequence = 0;
+      for (uint8_t i = 0; i < N; i++)
+        _status[i] = VEML6030_OK;
+    }
+
+    // This function adds a sensor to the array. Returns false if the array is
+    // full.
+    bool add(SparkFun_Ambient_Light_A &sensor){
+      if (_count >= N)
+        return false;
+      _sensors[_count++] = &sensor;
+      return true;
+    }
+
+    // This function returns the number of sensors added so far.
+    uint8_t size(){ return _count; }
+
+    // This function (re)starts sampling. The slowest sensor's refresh period
+    // is used to space the start times. Returns VEML6030_BUS_ERROR if any
+    // sensor could not be shut down, see status(); sampling starts anyway, but
+    // such a sensor keeps converting out of its slot until it is.
+    VEML6030_STATUS start(uint32_t now){
+      VEML6030_STATUS result = VEML6030_OK;
+      _period = 0;
+      for (uint8_t i = 0; i < _count; i++) {
+        uint32_t period = _sensors[i]->refreshPeriodMs();
+        if (period > _period)
+          _period = period;
+        _status[i] = _sensors[i]->shutDown();
+        if (_status[i] != VEML6030_OK)
+          result = _status[i];
+      }
+
+      _startAt = now;
+      _pending = 0;
+      _received = 0;
+      return result;
+    }
+
+    // This function returns the status of the last write start() or poll() made
+    // to sensor i: its shut down until its slot comes, then its power up. poll()
+    // retries a power up that failed on every call until it succeeds.
+    VEML6030_STATUS status(uint8_t i){ return (i < _count) ? _status[i] : VEML6030_INVALID_SETTING; }
+
+    // This function starts any sensor whose slot has come and reads any sensor
+    // that has a new sample. Returns true when a frame has been completed by
+    // this call; the frame stays available from frame() until the next one is
+    // completed.
+    bool poll(uint32_t now){
+      // Start the remaining sensors at their offset into the first period.
+      // The offsets count from the first sensor's power up, so the time
+      // start() spent shutting the sensors down does not shorten the first
+      // slot.
+      uint8_t started = _pending;
+      while (_pending < _count &&
+             (int32_t)(now - (_startAt + (_period * _pending) / _count)) >= 0) {
+        if (_pending == 0)
+          _startAt = now;
+        _status[_pending] = _sensors[_pending]->startMeasurement(now);
+        _pending++;
+      }
+
+      bool complete = false;
+      for (uint8_t i = 0; i < _pending; i++) {
+        // A power up that failed is retried from the next call on.
+        if (i < started && _status[i] != VEML6030_OK)
+          _status[i] = _sensors[i]->startMeasurement(now);
+        if (!_sensors[i]->poll(now))
+          continue;
+
+        // A sensor that is a full period ahead of the rest overwrites its
+        // own entry, which keeps the skew within one period.
+        _building.lux[i] = _sensors[i]->takeSample();
+        _building.timestamp[i] = now;
+        _received |= (1UL << i);
+
+        if (_received == _allReceived()) {
+          _publish();
+          complete = true;
+        }
+      }
+
+      return complete;
+    }
+
+    // This function returns the last completed frame.
+    const Frame &frame(){ return _frame; }
+
+  private:
+
+    uint32_t _allReceived(){ return (_count >= 32) ? 0xFFFFFFFF : ((1UL << _count) - 1); }
+
+    void _publish(){
+      uint32_t oldest = _building.timestamp[0];
+      uint32_t newest = oldest;
+      for (uint8_t i = 1; i < _count; i++) {
+        if ((int32_t)(_building.timestamp[i] - oldest) < 0)
+          oldest = _building.timestamp[i];
+        if ((int32_t)(_building.timestamp[i] - newest) > 0)
+          newest = _building.timestamp[i];
+      }
+
+      for (uint8_t i = 0; i < _count; i++) {
+        _frame.lux[i] = _building.lux[i];
+        _frame.timestamp[i] = _building.timestamp[i];
+      }
+      _frame.skew = newest - oldest;
+      _frame.sequence++;
+      _received = 0;
+    }
+
+    SparkFun_Ambient_Light_A *_sensors[N];
+    uint8_t _count;
+    uint32_t _period;
+    uint32_t _startAt;
+    uint8_t _pending;     // Sensors started so far
+    uint32_t _received;   // One bit per sensor with a sample in _building
+    VEML6030_STATUS _status[N];
+
+    Frame _building;
+    Frame _frame;
+};
+#endif
@@ -0,0 +1,228 @@
+/*
+  This is the C++20 coroutine layer of the SparkFun VEML6030 library, for
+  hosted builds such as Linux gateways: a single-threaded executor and
+  awaitable sensor access that waits on timers instead of delay().
+ */
+
+#include "SparkFun_VEML6030_Async.h"
+
+#ifdef VEML6030_HAS_COROUTINES
+
+#include <algorithm>
+
+VEML6030Executor::VEML6030Executor() : _finished(0), _sequence(0) {}
+
+// Destroying a root destroys the task it holds, and with it every task that
+// task is awaiting. The queues only point into those frames.
+VEML6030Executor::~VEML6030Executor()
+{
+
+  for (size_t i = 0; i < _roots.size(); i++)
+    _roots[i].destroy();
+
+}
+
+VEML6030Executor::_Detached VEML6030Executor::_runDetached(VEML6030Executor &_executor, VEML6030Task<void> _task)
+{
+
+  co_await _task;
+  _executor._finished++;
+
+}
+
+// This function hands a task to the executor, which runs it on the next
+// poll() and frees it when it finishes. Tasks still unfinished when the
+// executor is destroyed are freed with it.
+void VEML6030Executor::spawn(VEML6030Task<void> task)
+{
+
+  std::coroutine_handle<> root = _runDetached(*this, std::move(task)).handle;
+  _roots.push_back(root);
+  _ready.push_back(root);
+
+}
+
+// Heap order: the timer due last (or, due at the same time, added last) sinks.
+bool VEML6030Executor::_later(const _Timer &_a, const _Timer &_b)
+{
+
+  int32_t diff = (int32_t)(_a.dueAt - _b.dueAt);
+  return (diff != 0) ? (diff > 0) : (int32_t)(_a.sequence - _b.sequence) > 0;
+
+}
+
+void VEML6030Executor::_addTimer(uint32_t _dueAt, std::coroutine_handle<> _waiter)
+{
+
+  _timers.push_back(_Timer{_dueAt, _sequence++, _waiter});
+  std::push_heap(_timers.begin(), _timers.end(), _later);
+
+}
+
+// This function resumes every coroutine that was ready or whose timer was
+// due at now when it was called. Coroutines that yield() meanwhile run on
+// the next call. Returns the number of coroutines resumed.
+uint32_t VEML6030Executor::poll(uint32_t now)
+{
+
+  while (!_timers.empty() && (int32_t)(_timers.front().dueAt - now) <= 0) {
+    std::pop_heap(_timers.begin(), _timers.end(), _later);
+    _ready.push_back(_timers.back().waiter);
+    _timers.pop_back();
+  }
+
+  uint32_t resumed = 0;
+  for (size_t pending = _ready.size(); pending > 0; pending--) {
+    std::coroutine_handle<> next = _ready.front();
+    _ready.pop_front();
+    next.resume();
+    resumed++;
+  }
+
+  if (_finished) {
+    for (size_t i = 0; i < _roots.size(); ) {
+      if (_roots[i].done()) {
+        _roots[i].destroy();
+        _roots[i] = _roots.back();
+        _roots.pop_back();
+      }
+      else
+        i++;
+    }
+    _finished = 0;
+  }
+
+  return resumed;
+
+}
+
+// This function returns the time of the earliest timer, or now if a
+// coroutine is ready to run. Only meaningful while tasks() > 0.
+uint32_t VEML6030Executor::nextDueAt(uint32_t now)
+{
+
+  if (!_ready.empty() || _timers.empty())
+    return now;
+  return _timers.front().dueAt;
+
+}
+
+// This function runs until every spawned task has finished, calling delay()
+// whenever nothing is due.
+void VEML6030Executor::run()
+{
+
+  while (tasks() > 0) {
+    uint32_t now = millis();
+    poll(now);
+    if (tasks() == 0)
+      break;
+
+    now = millis();
+    int32_t wait = (int32_t)(nextDueAt(now) - now);
+    if (wait > 0)
+      delay(wait);
+  }
+
+}
+
+VEML6030Async::VEML6030Async(SparkFun_Ambient_Light_A &sensor, VEML6030Executor &executor) :
+  _sensor(sensor), _executor(executor), _measuring(false) {}
+
+// This function starts the sensor on the given transport with the given
+// configuration, like SparkFun_Ambient_Light_A::begin(config, transport),
+// but waits for the power up on a timer. Costs one extra register read to
+// find out whether the sensor has to be woken.
+VEML6030Task<VEML6030_START> VEML6030Async::begin(VEML6030Transport &transport, VEML6030Config config)
+{
+
+  _measuring = false;
+
+  uint16_t settingReg;
+  if (transport.readRegister(SETTING_REG, settingReg) != VEML6030_OK)
+    co_return VEML6030_START_FAILED;
+
+  // A running sensor, or one that is to stay down, never makes begin() wait.
+  if (!(settingReg & ~SD_MASK) || config.shutDown)
+    co_return _sensor.begin(config, transport);
+
+  // Otherwise configure it while it is still down and wake it here.
+  VEML6030Config asleep = config;
+  asleep.shutDown = true;
+  VEML6030_START started = _sensor.begin(asleep, transport);
+  if (started == VEML6030_START_FAILED)
+    co_return started;
+  if (_sensor.powerOnNoWait() != VEML6030_OK)
+    co_return VEML6030_START_FAILED;
+  co_await _executor.sleepFor(VEML6030::WAKE_TIME_MS);
+  co_return VEML6030_COLD_START;
+
+}
+
+// REG0x00, bit[0]
+// These functions power the sensor up, waiting VEML6030::WAKE_TIME_MS on a
+// timer, and down.
+VEML6030Task<VEML6030_STATUS> VEML6030Async::powerOn()
+{
+
+  VEML6030_STATUS status = _sensor.powerOnNoWait();
+  if (status == VEML6030_OK)
+    co_await _executor.sleepFor(VEML6030::WAKE_TIME_MS);
+  co_return status;
+
+}
+
+VEML6030Task<VEML6030_STATUS> VEML6030Async::shutDown()
+{
+
+  _measuring = false;
+  co_return _sensor.shutDown();
+
+}
+
+// REG0x00, bits[12:11] and bits[9:6]
+// This function writes the gain and integration time. It finishes with the
+// write; the next nextSample() then waits for a full conversion with the
+// new setting.
+VEML6030Task<VEML6030_STATUS> VEML6030Async::applyGain(VEML6030::Gain gain, VEML6030::IntegTime time)
+{
+
+  co_return _sensor.setGainAndIntegTime(gain, time);
+
+}
+
+// This function writes a whole configuration, see
+// SparkFun_Ambient_Light_A::applyConfig().
+VEML6030Task<VEML6030_STATUS> VEML6030Async::applyConfig(VEML6030Config config)
+{
+
+  // A configuration that shuts the sensor down ends the measurement.
+  if (config.shutDown)
+    _measuring = false;
+  co_return _sensor.applyConfig(config);
+
+}
+
+// REG0x04, bits[15:0]
+// This function waits for the next fresh sample and returns it in lux like
+// takeSample(). The first call starts the measurement, waking the sensor if
+// needed. Every call after it returns a different conversion, one refresh
+// period apart. Check lastStatus() for bus errors.
+VEML6030Task<uint32_t> VEML6030Async::nextSample()
+{
+
+  if (!_measuring) {
+    _sensor.startMeasurement(millis());
+    _measuring = true;
+  }
+
+  // poll() restarts the wait itself after a change of settings, which moves
+  // nextSampleDueAt() on.
+  while (!_sensor.poll(millis()))
+    co_await _executor.sleepUntil(_sensor.nextSampleDueAt());
+
+  co_return _sensor.takeSample();
+
+}
+
+#endif
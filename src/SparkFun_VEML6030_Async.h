@@ -0,0 +1,290 @@
+#ifndef _SPARKFUN_VEML6030_ASYNC_H_
+#define _SPARKFUN_VEML6030_ASYNC_H_
+
+// The coroutine layer needs C++20 and a hosted standard library, so Arduino
+// builds leave it out, as do hosted builds in an older language mode.
+#if !defined(ARDUINO) && __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<coroutine>)
+#define VEML6030_HAS_COROUTINES
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class VEML6030Executor;
+
+// The return type of a coroutine that produces a T, e.g.
+//
+//   VEML6030Task<uint32_t> average(VEML6030Async &light){
+//     uint32_t sum = 0;
+//     for (int i = 0; i < 4; i++)
+//       sum += co_await light.nextSample();
+//     co_return sum / 4;
+//   }
+//
+// A task starts when it is awaited (or handed to VEML6030Executor::spawn())
+// and resumes its awaiter when it finishes. It owns its coroutine frame, so a
+// task must outlive the await. The library does not use exceptions; one
+// escaping a coroutine ends the program.
+template <typename T = void>
+class VEML6030Task;
+
+namespace VEML6030 {
+
+  // Common part of the task promises: lazy start, and on completion a
+  // symmetric transfer back to whoever awaited the task.
+  struct TaskPromiseBase
+  {
+    struct FinalAwaiter
+    {
+      bool await_ready() noexcept { return false; }
+      template <typename P>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<P> done) noexcept {
+        std::coroutine_handle<> next = done.promise().continuation;
+        return next ? next : std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    std::coroutine_handle<> continuation;
+  };
+
+  template <typename T>
+  struct TaskPromise : TaskPromiseBase
+  {
+    VEML6030Task<T> get_return_object() noexcept;
+    void return_value(T value) noexcept { result = std::move(value); }
+    T result{};
+  };
+
+  template <>
+  struct TaskPromise<void> : TaskPromiseBase
+  {
+    VEML6030Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+  };
+
+}
+
+template <typename T>
+class VEML6030Task
+{
+  public:
+
+    using promise_type = VEML6030::TaskPromise<T>;
+
+    VEML6030Task(VEML6030Task &&other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    VEML6030Task &operator=(VEML6030Task &&other) noexcept {
+      if (this != &other) {
+        if (_handle)
+          _handle.destroy();
+        _handle = std::exchange(other._handle, {});
+      }
+      return *this;
+    }
+    ~VEML6030Task(){
+      if (_handle)
+        _handle.destroy();
+    }
+
+    // Awaiting a task runs it until it finishes and gives its result.
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+      _handle.promise().continuation = awaiter;
+      return _handle;
+    }
+    T await_resume() noexcept {
+      if constexpr (!std::is_void<T>::value)
+        return std::move(_handle.promise().result);
+    }
+
+  private:
+
+    friend promise_type;
+    explicit VEML6030Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+template <typename T>
+VEML6030Task<T> VEML6030::TaskPromise<T>::get_return_object() noexcept {
+  return VEML6030Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline VEML6030Task<void> VEML6030::TaskPromise<void>::get_return_object() noexcept {
+  return VEML6030Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// A single-threaded executor for VEML6030Task. Coroutines suspend on its
+// timers (sleepUntil(), sleepFor()) instead of blocking, so one thread can
+// wait on any number of sensors at once. Time is millis(), like the rest of
+// the library. Either let run() own the thread, or call poll() from an
+// existing event loop and sleep until nextDueAt().
+//
+// Bus transfers themselves are not awaited: a register access on the Linux
+// backend is one ioctl of well under a millisecond, which is done in place.
+// Everything the sensor has to be waited for (power up, conversions) goes
+// through the timers.
+class VEML6030Executor
+{
+  public:
+
+    VEML6030Executor();
+    ~VEML6030Executor();
+
+    VEML6030Executor(const VEML6030Executor &) = delete;
+    VEML6030Executor &operator=(const VEML6030Executor &) = delete;
+
+    // This function hands a task to the executor, which runs it on the next
+    // poll() and frees it when it finishes. Tasks still unfinished when the
+    // executor is destroyed are freed with it.
+    void spawn(VEML6030Task<void> task);
+
+    // This function returns the number of spawned tasks not yet finished.
+    size_t tasks(){ return _roots.size() - _finished; }
+
+    // These functions suspend the awaiting coroutine until the given millis()
+    // time, for the given number of milliseconds, or until every other
+    // coroutine that is ready has had a turn.
+    struct SleepAwaiter
+    {
+      VEML6030Executor &executor;
+      uint32_t dueAt;
+      bool await_ready() const noexcept { return (int32_t)(dueAt - (uint32_t)millis()) <= 0; }
+      void await_suspend(std::coroutine_handle<> waiter){ executor._addTimer(dueAt, waiter); }
+      void await_resume() const noexcept {}
+    };
+    struct YieldAwaiter
+    {
+      VEML6030Executor &executor;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> waiter){ executor._ready.push_back(waiter); }
+      void await_resume() const noexcept {}
+    };
+    SleepAwaiter sleepUntil(uint32_t dueAt){ return SleepAwaiter{*this, dueAt}; }
+    SleepAwaiter sleepFor(uint32_t ms){ return SleepAwaiter{*this, (uint32_t)millis() + ms}; }
+    YieldAwaiter yield(){ return YieldAwaiter{*this}; }
+
+    // This function resumes every coroutine that was ready or whose timer was
+    // due at now when it was called. Coroutines that yield() meanwhile run on
+    // the next call. Returns the number of coroutines resumed.
+    uint32_t poll(uint32_t now);
+
+    // This function returns the time of the earliest timer, or now if a
+    // coroutine is ready to run. Only meaningful while tasks() > 0.
+    uint32_t nextDueAt(uint32_t now);
+
+    // This function runs until every spawned task has finished, calling
+    // delay() whenever nothing is due.
+    void run();
+
+  private:
+
+    struct _Timer
+    {
+      uint32_t dueAt;
+      uint32_t sequence;    // Keeps timers with the same due time in order
+      std::coroutine_handle<> waiter;
+    };
+
+    // Holds a spawned task and tells the executor when it is done. The frame
+    // stays until poll() frees it.
+    struct _Detached
+    {
+      struct promise_type
+      {
+        _Detached get_return_object() noexcept {
+          return _Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+      };
+      std::coroutine_handle<promise_type> handle;
+    };
+
+    static _Detached _runDetached(VEML6030Executor &_executor, VEML6030Task<void> _task);
+
+    static bool _later(const _Timer &_a, const _Timer &_b);
+    void _addTimer(uint32_t _dueAt, std::coroutine_handle<> _waiter);
+
+    std::deque<std::coroutine_handle<>> _ready;
+    std::vector<_Timer> _timers;   // Min-heap on dueAt, then sequence
+    std::vector<std::coroutine_handle<>> _roots;   // One per spawned task
+    size_t _finished;   // Roots done but not yet freed
+    uint32_t _sequence;
+};
+
+// Awaitable access to one sensor. The sensor object does the work as usual;
+// this class replaces its blocking waits with executor timers:
+//
+//   VEML6030Task<void> logger(VEML6030Async &light){
+//     co_await light.applyGain(VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms100);
+//     for (;;)
+//       printf("%u lux\n", co_await light.nextSample());
+//   }
+//
+// Each instance tracks its sensor's non-blocking measurement (see
+// SparkFun_Ambient_Light_A::poll()), so that sensor should not be polled or
+// shut down behind its back while coroutines use it. Configurations are taken
+// by value, as the coroutine may run after the caller's copy is gone.
+class VEML6030Async
+{
+  public:
+
+    VEML6030Async(SparkFun_Ambient_Light_A &sensor, VEML6030Executor &executor);
+
+    // This function starts the sensor on the given transport with the given
+    // configuration, like SparkFun_Ambient_Light_A::begin(config, transport),
+    // but waits for the power up on a timer. Costs one extra register read to
+    // find out whether the sensor has to be woken.
+    VEML6030Task<VEML6030_START> begin(VEML6030Transport &transport,
+                                       VEML6030Config config = VEML6030Config());
+
+    // REG0x00, bit[0]
+    // These functions power the sensor up, waiting VEML6030::WAKE_TIME_MS on a
+    // timer, and down.
+    VEML6030Task<VEML6030_STATUS> powerOn();
+    VEML6030Task<VEML6030_STATUS> shutDown();
+
+    // REG0x00, bits[12:11] and bits[9:6]
+    // This function writes the gain and integration time. It finishes with the
+    // write; the next nextSample() then waits for a full conversion with the
+    // new setting.
+    VEML6030Task<VEML6030_STATUS> applyGain(VEML6030::Gain gain, VEML6030::IntegTime time);
+
+    // This function writes a whole configuration, see
+    // SparkFun_Ambient_Light_A::applyConfig().
+    VEML6030Task<VEML6030_STATUS> applyConfig(VEML6030Config config);
+
+    // REG0x04, bits[15:0]
+    // This function waits for the next fresh sample and returns it in lux like
+    // takeSample(). The first call starts the measurement, waking the sensor
+    // if needed. Every call after it returns a different conversion, one
+    // refresh period apart. Check lastStatus() for bus errors.
+    VEML6030Task<uint32_t> nextSample();
+
+    // This function returns the status of the sensor's last transfer.
+    VEML6030_STATUS lastStatus(){ return _sensor.lastStatus(); }
+
+    SparkFun_Ambient_Light_A &sensor(){ return _sensor; }
+
+  private:
+
+    SparkFun_Ambient_Light_A &_sensor;
+    VEML6030Executor &_executor;
+    bool _measuring;
+};
+
+#endif
+#endif
+#endif
@@ -0,0 +1,136 @@
+#ifndef _SPARKFUN_VEML6030_FIXED_H_
+#define _SPARKFUN_VEML6030_FIXED_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+// A VEML6030 whose gain and integration time are fixed at compile time, e.g.
+//
+//   VEML6030Fixed<VEML6030::Gain::X1_8, VEML6030::IntegTime::Ms100> light(0x48);
+//
+// The lux per count, whether the compensation formula can ever apply and the
+// interrupt threshold encoding are all constants, so a light read is one bus
+// read and a multiply by a constant. It uses the same transport as
+// SparkFun_Ambient_Light_A. Use the runtime class if the settings must change
+// after boot.
+template <VEML6030::Gain GAIN, VEML6030::IntegTime INTEG_TIME>
+class VEML6030Fixed
+{
+  public:
+
+    // Conversion step (see VEML6030::rawToMilliLux) and lux per count.
+    static constexpr uint8_t CONV_STEP = VEML6030::convStep(GAIN, INTEG_TIME);
+    static constexpr float LUX_CONV = .0036f * (1 << CONV_STEP);
+
+    // The largest uncompensated reading is 65535 counts. The compensation
+    // formula only applies above 1000 lux, so at the three finest steps it is
+    // compiled out completely.
+    static constexpr bool MAY_COMPENSATE = (65535UL * (36UL << CONV_STEP)) / 10000 > 1000;
+
+    // This function converts a lux value to threshold register bits. With a
+    // constant argument it is evaluated at compile time, otherwise it is one
+    // division by a constant. Values beyond the range of the setting (or above
+    // 120000 lux) are clamped to 0xFFFF.
+    static constexpr uint16_t luxToBits(uint32_t luxVal){
+      return (luxVal > 120000 || luxVal * 10000UL / (36UL << CONV_STEP) > 0xFFFF) ? 0xFFFF :
+             (uint16_t)(luxVal * 10000UL / (36UL << CONV_STEP));
+    }
+
+    VEML6030Fixed(uint8_t address) : _bus(address), _settingReg(SETTING) {}
+
+    // This function checks that the sensor answers, then writes the fixed gain
+    // and integration time and powers the sensor up. Returns false if the
+    // sensor did not answer or did not take the write.
+    bool begin(TwoWire &wirePort = Wire){
+      _bus.begin(wirePort);
+      _settingReg = SETTING;
+      if (!_bus.isConnected())
+        return false;
+      if (_bus.writeRegister(SETTING_REG, _settingReg) != VEML6030_OK)
+        return false;
+      delay(VEML6030::WAKE_TIME_MS);
+      return true;
+    }
+
+    // This function converts a raw count to lux like readLight_A(), without
+    // touching the bus. The counts are converted like the runtime class does
+    // in the same build: with the float constant, or exactly in the footprint
+    // optimized build.
+    static uint32_t bitsToLux(uint16_t lightBits){
+#ifdef VEML6030_FOOTPRINT_OPTIMIZED
+      uint32_t luxVal = VEML6030::rawToMilliLux(lightBits, CONV_STEP) / 1000;
+#else
+      uint32_t luxVal = LUX_CONV * lightBits;
+#endif
+      if (MAY_COMPENSATE && luxVal > 1000)
+        return VEML6030::compensateLux(luxVal);
+      return luxVal;
+    }
+
+    // REG[0x04], bits[15:0]
+    // This function gets the ambient light's lux value, with the compensation
+    // formula above 1000 lux like SparkFun_Ambient_Light_A::readLight_A(). The
+    // compensation is done in fixed point (VEML6030::compensateLux), so a
+    // compensated value can be one lux below the runtime class's.
+    uint32_t readLight_A(){
+      return bitsToLux(_bus.readRegister(AMBIENT_LIGHT_DATA_REG));
+    }
+
+    // REG[0x05], bits[15:0]
+    // This function gets the white light's lux value.
+    uint32_t readWhiteLight(){
+      return bitsToLux(_bus.readRegister(WHITE_LIGHT_DATA_REG));
+    }
+
+    // REG[0x04], bits[15:0]
+    // This function gets the ambient light value in milli-lux using integer
+    // math only, see SparkFun_Ambient_Light_A::readLightMilliLux().
+    uint32_t readLightMilliLux(){
+      uint32_t milliLux = ((uint32_t)_bus.readRegister(AMBIENT_LIGHT_DATA_REG) * (36UL << CONV_STEP)) / 10;
+      if (MAY_COMPENSATE && milliLux >= 1001000)
+        return VEML6030::compensateMilliLux(milliLux);
+      return milliLux;
+    }
+
+    // REG0x01 and REG0x02, bits[15:0]
+    // These functions set the upper and lower interrupt limits in lux.
+    VEML6030_STATUS setIntHighThresh(uint32_t luxVal){ return _bus.writeRegister(H_THRESH_REG, luxToBits(luxVal)); }
+    VEML6030_STATUS setIntLowThresh(uint32_t luxVal){ return _bus.writeRegister(L_THRESH_REG, luxToBits(luxVal)); }
+
+    // REG0x00, bit[1]
+    // These functions enable and disable the interrupt. SETTING_REG is only
+    // ever written by this class, so no read is needed first.
+    VEML6030_STATUS enableInt(){ return _writeSetting(_settingReg | (VEML6030::BIT_ENABLE << INT_EN_POS)); }
+    VEML6030_STATUS disableInt(){ return _writeSetting(_settingReg & INT_EN_MASK); }
+
+    // REG0x06, bits[15:14]
+    // This function reads which interrupt, if any, has been triggered:
+    // VEML6030::INT_NONE, INT_ABOVE or INT_BELOW.
+    uint8_t readInterrupt(){
+      uint8_t regVal = (_bus.readRegister(INTERRUPT_REG) & INT_MASK) >> INT_POS;
+      return (regVal > VEML6030::INT_BELOW) ? (uint8_t)VEML6030::UNKNOWN : regVal;
+    }
+
+    // REG0x00, bit[0]
+    // These functions power the sensor down and back up.
+    VEML6030_STATUS shutDown(){ return _writeSetting(_settingReg | VEML6030::BIT_SHUTDOWN); }
+    VEML6030_STATUS powerOn(){
+      VEML6030_STATUS status = _writeSetting(_settingReg & SD_MASK);
+      delay(VEML6030::WAKE_TIME_MS);
+      return status;
+    }
+
+  private:
+
+    static constexpr uint16_t SETTING = ((uint16_t)GAIN << GAIN_POS) | ((uint16_t)INTEG_TIME << INTEG_POS);
+
+    VEML6030_STATUS _writeSetting(uint16_t _value){
+      VEML6030_STATUS status = _bus.writeRegister(SETTING_REG, _value);
+      if (status == VEML6030_OK)
+        _settingReg = _value;
+      return status;
+    }
+
+    VEML6030WireTransport _bus;
+    uint16_t _settingReg;
+};
+#endif
@@ -0,0 +1,134 @@
+/*
+  High dynamic range acquisition for the SparkFun VEML6030 library, see
+  SparkFun_VEML6030_HDR.h.
+ */
+
+#include "SparkFun_VEML6030_HDR.h"
+
+VEML6030HDR::VEML6030HDR(SparkFun_Ambient_Light_A &sensor)
+{
+
+  _sensor = &sensor; 
+  _running = false; 
+  _dueAt = 0; 
+  _raw[0] = _raw[1] = 0; 
+  _milliLux = 0; 
+  _resolution = 0; 
+  _noise = 0; 
+  _firstWeight = 0; 
+
+}
+
+// This function starts alternating between the two settings, beginning with
+// the first. now is in milliseconds, usually millis(). 
+VEML6030_STATUS VEML6030HDR::begin(VEML6030::Gain firstGain, VEML6030::IntegTime firstTime,
+                                   VEML6030::Gain secondGain, VEML6030::IntegTime secondTime,
+                                   uint32_t now){
+
+  _gain[0] = firstGain; 
+  _time[0] = firstTime; 
+  _gain[1] = secondGain; 
+  _time[1] = secondTime; 
+
+  // Power save is off while alternating, so the conversion running with the
+  // other setting takes one integration time. Before the first window it is
+  // whatever the sensor is doing.
+  for (uint8_t i = 0; i < 2; i++) {
+    _convStep[i] = VEML6030::convStep(_gain[i], _time[i]); 
+    _windowMs[i] = VEML6030::settleTimeMs(VEML6030::refreshTimeMs(_time[i ^ 1], 0),
+                                          VEML6030::refreshTimeMs(_time[i], 0)); 
+    _haveRaw[i] = false; 
+  }
+  uint32_t firstWindow = VEML6030::settleTimeMs(_sensor->refreshPeriodMs(),
+                                                VEML6030::refreshTimeMs(_time[0], 0)); 
+
+  VEML6030_STATUS status = _sensor->disablePowSave(); 
+  if (status == VEML6030_OK)
+    status = _sensor->setGainAndIntegTime(_gain[0], _time[0]); 
+  if (status != VEML6030_OK)
+    return status; 
+
+  _active = 0; 
+  _dueAt = now + firstWindow; 
+  _running = true; 
+  return VEML6030_OK; 
+
+}
+
+// This function stops alternating. The sensor keeps the setting it is in. 
+void VEML6030HDR::end(){
+
+  _running = false; 
+
+}
+
+// This function reads the sensor when its window has ended and switches to
+// the other setting. 
+bool VEML6030HDR::poll(uint32_t now){
+
+  if (!_running || (int32_t)(now - _dueAt) < 0)
+    return false; 
+
+  uint16_t raw; 
+  if (_sensor->readLightRaw(raw) != VEML6030_OK)
+    return false; // Try again on the next call.
+
+  // Start the other window before doing anything else with the count. If the
+  // write fails the sensor stays on the same setting and is read again.
+  uint8_t done = _active; 
+  if (_sensor->setGainAndIntegTime(_gain[done ^ 1], _time[done ^ 1]) == VEML6030_OK)
+    _active = done ^ 1; 
+  _dueAt = now + _windowMs[_active]; 
+
+  _raw[done] = raw; 
+  _haveRaw[done] = true; 
+  if (!_haveRaw[0] || !_haveRaw[1])
+    return false; 
+
+  _fuse(); 
+  return true; 
+
+}
+
+// This function fuses the last count of each setting into one value. 
+void VEML6030HDR::_fuse(){
+
+  float value[2], step[2], weight[2] = {0, 0}; 
+  bool usable[2]; 
+  int8_t finest = -1; 
+
+  for (uint8_t i = 0; i < 2; i++) {
+    step[i] = 3.6f * (1 << _convStep[i]); // milli-lux per count
+    value[i] = VEML6030::rawToMilliLux(_raw[i], _convStep[i]); 
+    usable[i] = (_raw[i] < SATURATED); 
+    if (usable[i] && (finest < 0 || step[i] < step[finest]))
+      finest = i; 
+  }
+
+  // Both saturated: the coarser setting is the better guess.
+  if (finest < 0) {
+    uint8_t coarse = (step[1] > step[0]) ? 1 : 0; 
+    usable[coarse] = true; 
+    finest = coarse; 
+  }
+
+  // The variance of a count is about the count itself, plus 1/12 for rounding.
+  // Both are evaluated at the finest usable reading, so a coarse setting that
+  // reads only a few counts is not trusted more than it deserves.
+  float level = value[finest]; 
+  float weightSum = 0, invStepSq = 0; 
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!usable[i])
+      continue; 
+    weight[i] = 1 / (step[i] * level + step[i] * step[i] / 12); 
+    weightSum += weight[i]; 
+    invStepSq += 1 / (step[i] * step[i]); 
+  }
+
+  uint32_t fused = (weight[0] * value[0] + weight[1] * value[1]) / weightSum + .5f; 
+  _milliLux = (fused >= 1001000) ? VEML6030::compensateMilliLux(fused) : fused; 
+  _noise = sqrt(1 / weightSum); 
+  _resolution = 1 / sqrt(invStepSq); 
+  _firstWeight = weight[0] / weightSum; 
+
+}
@@ -0,0 +1,104 @@
+#ifndef _SPARKFUN_VEML6030_HDR_H_
+#define _SPARKFUN_VEML6030_HDR_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+// High dynamic range acquisition: the sensor alternates between two gain and
+// integration time settings, typically a fine one for low light and a coarse
+// one that reaches 120000 lux, and every new reading is fused with the last
+// reading of the other setting into one estimate.
+//
+// The fusion weighs each reading by the inverse of its variance, modelled as
+// the count's own variance (about the count itself, plus 1/12 for rounding)
+// times the square of the lux per count, both taken at the light level the
+// finest usable reading sees. Readings at or above 0xE000 counts, where the
+// sensor stops being linear, get no weight. The fine setting thus
+// dominates in low light and drops out as it saturates. resolutionMilliLux()
+// reports the step size of an ideal single setting that would be as fine as
+// the combination.
+//
+// After each switch the count is read once a full integration with the new
+// setting is certain to have ended, VEML6030::settleTimeMs() after the write:
+// the integration that was running with the old setting may finish first, so
+// the wait is both integration times plus SETTLE_GUARD_MS. A fused value comes
+// out after every such window, so with integration times a and b there is one
+// every a + b + 2ms, e.g. 127ms for 100ms and 25ms. Built with
+// VEML6030_WRITE_RESTARTS_CONVERSION (see the top of
+// SparkFun_VEML6030_Ambient_Light_Sensor_A.h) the wait is the new integration
+// time plus the guard alone: 102 and 27ms in turn, nearly twice the rate.
+//
+// Power save mode is turned off, and the sensor's auto-range, event mode and
+// startMeasurement() must not be used at the same time. Enable the shadow cache
+// so each switch is a single write.
+class VEML6030HDR
+{
+  public:
+
+    VEML6030HDR(SparkFun_Ambient_Light_A &sensor);
+
+    // This function starts alternating between the two settings, beginning with
+    // the first. now is in milliseconds, usually millis(). 
+    VEML6030_STATUS begin(VEML6030::Gain firstGain, VEML6030::IntegTime firstTime,
+                          VEML6030::Gain secondGain, VEML6030::IntegTime secondTime,
+                          uint32_t now);
+
+    // This function stops alternating. The sensor keeps the setting it is in. 
+    void end();
+
+    // This function reads the sensor when its window has ended and switches to
+    // the other setting. Returns true when a new fused value is available,
+    // which is after every window once both settings have been read once. 
+    bool poll(uint32_t now);
+
+    // This function returns when poll() will next read the sensor. 
+    uint32_t nextDueAt(){ return _dueAt; }
+
+    // These functions return the last fused value, in milli-lux with the
+    // compensation formula applied above 1000 lux like readLightMilliLux(),
+    // and in lux. 
+    uint32_t milliLux(){ return _milliLux; }
+    uint32_t lux(){ return _milliLux / 1000; }
+
+    // This function returns the effective resolution of the last fused value:
+    // the lux per count of a single setting as fine as the usable readings
+    // combined, in milli-lux. 
+    float resolutionMilliLux(){ return _resolution; }
+
+    // This function returns the modelled standard deviation of the last fused
+    // value before compensation, in milli-lux. 
+    float noiseMilliLux(){ return _noise; }
+
+    // This function returns the share, from 0 to 1, the first setting had in
+    // the last fused value. 
+    float firstWeight(){ return _firstWeight; }
+
+    // These functions return the last raw count of each setting. 
+    uint16_t firstRaw(){ return _raw[0]; }
+    uint16_t secondRaw(){ return _raw[1]; }
+
+  private:
+
+    // Counts from here up are treated as saturated.
+    static const uint16_t SATURATED = 0xE000;
+
+    void _fuse();
+
+    SparkFun_Ambient_Light_A *_sensor;
+
+    VEML6030::Gain _gain[2];
+    VEML6030::IntegTime _time[2];
+    uint8_t _convStep[2];
+    uint16_t _windowMs[2];   // Wait after switching to each setting
+
+    bool _running;
+    uint8_t _active;         // Setting being integrated
+    uint32_t _dueAt;
+    uint16_t _raw[2];
+    bool _haveRaw[2];
+
+    uint32_t _milliLux;
+    float _resolution;
+    float _noise;
+    float _firstWeight;
+};
+#endif
@@ -0,0 +1,162 @@
+/*
+  This is the Linux i2c-dev backend of the SparkFun VEML6030 library. It lets
+  the library run on Linux boards such as gateways, talking to the sensor
+  through the kernel's /dev/i2c-N interface.
+ */
+
+#include "SparkFun_VEML6030_LinuxI2C.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+int VEML6030I2CDevOps::open(const char *path)
+{
+
+  return ::open(path, O_RDWR); 
+
+}
+
+int VEML6030I2CDevOps::close(int fd)
+{
+
+  return ::close(fd); 
+
+}
+
+int VEML6030I2CDevOps::rdwr(int fd, struct i2c_rdwr_ioctl_data *data)
+{
+
+  return ::ioctl(fd, I2C_RDWR, data); 
+
+}
+
+VEML6030I2CDevOps &VEML6030I2CDevOps::system()
+{
+
+  static VEML6030I2CDevOps ops; 
+  return ops; 
+
+}
+
+VEML6030LinuxI2C::VEML6030LinuxI2C(uint8_t address, VEML6030I2CDevOps &ops) : VEML6030Transport(address)
+{
+
+  _ops = &ops; 
+  _fd = -1; 
+  _ownsFd = false; 
+
+}
+
+VEML6030LinuxI2C::~VEML6030LinuxI2C()
+{
+
+  close(); 
+
+}
+
+// These functions open an adapter by bus number (/dev/i2c-N) or by path.
+// They return false if it cannot be opened; errno tells why. 
+bool VEML6030LinuxI2C::open(uint8_t busNumber)
+{
+
+  char path[20]; 
+  snprintf(path, sizeof(path), "/dev/i2c-%u", busNumber); 
+  return open(path); 
+
+}
+
+bool VEML6030LinuxI2C::open(const char *path)
+{
+
+  close(); 
+  int fd = _ops->open(path); 
+  if (fd < 0)
+    return false; 
+
+  _fd = fd; 
+  _ownsFd = true; 
+  return true; 
+
+}
+
+// This function uses an adapter that is already open. It is not closed by
+// close() or the destructor. 
+void VEML6030LinuxI2C::open(int fd)
+{
+
+  close(); 
+  _fd = fd; 
+  _ownsFd = false; 
+
+}
+
+// This function closes the adapter if this object opened it. 
+void VEML6030LinuxI2C::close()
+{
+
+  if (_fd >= 0 && _ownsFd)
+    _ops->close(_fd); 
+  _fd = -1; 
+  _ownsFd = false; 
+
+}
+
+// This function checks if the sensor acknowledges its address by reading
+// SETTING_REG, which every VEML6030 answers.
+bool VEML6030LinuxI2C::isConnected()
+{
+
+  uint16_t regValue; 
+  return _readOnce(SETTING_REG, regValue) == VEML6030_OK; 
+
+}
+
+// A single write attempt: one message of register, LSB and MSB. 
+VEML6030_STATUS VEML6030LinuxI2C::_writeOnce(uint8_t _wReg, uint16_t _value)
+{
+
+  uint8_t _buf[3] = { _wReg, (uint8_t)(_value & 0xFF), (uint8_t)(_value >> 8) }; 
+  struct i2c_msg _msg = { _address, 0, sizeof(_buf), _buf }; 
+  struct i2c_rdwr_ioctl_data _data = { &_msg, 1 }; 
+
+  if (_fd < 0 || _ops->rdwr(_fd, &_data) != 1) {
+    _stats.nacks++; 
+    return VEML6030_BUS_ERROR; 
+  }
+  return VEML6030_OK; 
+
+}
+
+// A single read attempt: the register pointer write and the 2 byte read in one
+// combined transfer. 
+VEML6030_STATUS VEML6030LinuxI2C::_readOnce(uint8_t _reg, uint16_t &_value)
+{
+
+  uint8_t _buf[2]; 
+  struct i2c_msg _msgs[2] = {
+    { _address, 0, 1, &_reg },
+    { _address, I2C_M_RD, sizeof(_buf), _buf }
+  }; 
+  struct i2c_rdwr_ioctl_data _data = { _msgs, 2 }; 
+
+  int _ret = (_fd < 0) ? -1 : _ops->rdwr(_fd, &_data); 
+  if (_ret < 0) {
+    _stats.nacks++; 
+    return VEML6030_BUS_ERROR; 
+  }
+  if (_ret != 2) {
+    _stats.shortReads++; 
+    return VEML6030_BUS_ERROR; 
+  }
+
+  _value = _buf[0] | (uint16_t(_buf[1]) << 8); 
+  return VEML6030_OK; 
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef _SPARKFUN_VEML6030_LINUX_I2C_H_
+#define _SPARKFUN_VEML6030_LINUX_I2C_H_
+
+// The Linux i2c-dev backend is only built for Linux hosts; Arduino builds,
+// including Arduino cores running on Linux, leave it out.
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+// The system calls used by VEML6030LinuxI2C. The default implementation calls
+// the kernel; a program can pass its own to run the backend against a fake
+// i2c-dev, e.g. one that forwards to the simulated sensor in extras/host.
+class VEML6030I2CDevOps
+{
+  public:
+
+    virtual ~VEML6030I2CDevOps() {}
+
+    // open(path, O_RDWR), close(fd) and ioctl(fd, I2C_RDWR, data), with the
+    // return values and errno of the real calls.
+    virtual int open(const char *path);
+    virtual int close(int fd);
+    virtual int rdwr(int fd, struct i2c_rdwr_ioctl_data *data);
+
+    // The instance calling the kernel.
+    static VEML6030I2CDevOps &system();
+};
+
+// VEML6030Transport on a Linux /dev/i2c-N adapter. Every register access is a
+// single I2C_RDWR ioctl: a write is one 3 byte message, a read is the register
+// pointer write and the 2 byte read as two messages joined by a repeated
+// START. No I2C_SLAVE ioctl is needed, as the address travels with every
+// message, so several sensors can share one open adapter (see open(int fd)).
+class VEML6030LinuxI2C : public VEML6030Transport
+{
+  public:
+
+    VEML6030LinuxI2C(uint8_t address, VEML6030I2CDevOps &ops = VEML6030I2CDevOps::system());
+    ~VEML6030LinuxI2C();
+
+    // These functions open an adapter by bus number (/dev/i2c-N) or by path.
+    // They return false if it cannot be opened; errno tells why. 
+    bool open(uint8_t busNumber);
+    bool open(const char *path);
+
+    // This function uses an adapter that is already open. It is not closed by
+    // close() or the destructor. 
+    void open(int fd);
+
+    // This function closes the adapter if this object opened it. 
+    void close();
+
+    // This function returns the file descriptor in use, -1 if none. 
+    int fd() { return _fd; }
+
+    // This function returns the system calls in use. 
+    VEML6030I2CDevOps &ops() { return *_ops; }
+
+    // This function checks if the sensor acknowledges its address by reading
+    // SETTING_REG, which every VEML6030 answers.
+    bool isConnected();
+
+  protected:
+
+    VEML6030_STATUS _writeOnce(uint8_t _wReg, uint16_t _value);
+    VEML6030_STATUS _readOnce(uint8_t _reg, uint16_t &_value);
+
+  private:
+
+    VEML6030I2CDevOps *_ops;
+    int _fd;
+    bool _ownsFd;
+};
+
+// The ambient light registers of up to N sensors on one adapter, read with
+// as few I2C_RDWR ioctls as possible: each sensor adds its register pointer
+// write and 2 byte read to one message array, up to I2C_RDWR_IOCTL_MAX_MSGS
+// messages (21 sensors) per ioctl. The raw counts are then converted in bulk
+// with the conversion step each sensor has cached, without any more bus
+// traffic.
+//
+// The sensors are not owned by the batch and must have been started with
+// begin(), on any transport. Only two VEML6030 addresses exist, so more than
+// two sensors on one adapter need address translators; the channels of an
+// I2C mux show up as separate adapters and need a batch each.
+template <uint8_t N>
+class VEML6030LinuxBatch
+{
+    static_assert(N >= 1 && N <= 112, "VEML6030LinuxBatch holds 1 to 112 sensors");
+
+  public:
+
+    // Sensors per ioctl.
+    static const uint8_t SENSORS_PER_CALL = I2C_RDWR_IOCTL_MAX_MSGS / 2;
+
+    // The batch reads through the adapter opened by the given transport.
+    VEML6030LinuxBatch(VEML6030LinuxI2C &adapter)
+      : _adapter(&adapter), _count(0), _pointer(AMBIENT_LIGHT_DATA_REG) {}
+
+    // This function adds a sensor at the given address. Returns false if the
+    // batch is full.
+    bool add(SparkFun_Ambient_Light_A &sensor, uint8_t address){
+      if (_count >= N)
+        return false;
+      _sensors[_count] = &sensor;
+      _msgs[2 * _count].addr = address;
+      _msgs[2 * _count].flags = 0;
+      _msgs[2 * _count].len = 1;
+      _msgs[2 * _count].buf = &_pointer;
+      _msgs[2 * _count + 1].addr = address;
+      _msgs[2 * _count + 1].flags = I2C_M_RD;
+      _msgs[2 * _count + 1].len = 2;
+      _msgs[2 * _count + 1].buf = _rawBytes[_count];
+      _valid[_count] = false;
+      _count++;
+      return true;
+    }
+
+    // This function returns the number of sensors added so far.
+    uint8_t size(){ return _count; }
+
+    // This function reads every sensor's ambient light count. A NACK aborts
+    // the rest of its ioctl in the kernel, so that group of sensors is read
+    // again one by one to find the failing one; the others keep their
+    // values. Returns VEML6030_OK if every sensor was read.
+    VEML6030_STATUS read(){
+      VEML6030_STATUS status = VEML6030_OK;
+      for (uint8_t first = 0; first < _count; first += SENSORS_PER_CALL) {
+        uint8_t group = (_count - first < SENSORS_PER_CALL) ? _count - first : SENSORS_PER_CALL;
+        if (_transfer(first, group))
+          continue;
+        for (uint8_t i = first; i < first + group; i++)
+          if (!_transfer(i, 1))
+            status = VEML6030_BUS_ERROR;
+      }
+      return status;
+    }
+
+    // This function says if sensor i was read by the last read(). 
+    bool isValid(uint8_t i){ return _valid[i]; }
+
+    // This function returns sensor i's raw count from the last read(). 
+    uint16_t raw(uint8_t i){ return _raw[i]; }
+
+    // This function converts every count from the last read() to milli-lux,
+    // like readLightMilliLux(). Sensors that were not read give 0. 
+    void toMilliLux(uint32_t *milliLux){
+      for (uint8_t i = 0; i < _count; i++)
+        milliLux[i] = _valid[i] ? VEML6030::convertMilliLux(_raw[i], _convStep[i]) : 0;
+    }
+
+  private:
+
+    // Reads count sensors from first on in one ioctl.
+    bool _transfer(uint8_t first, uint8_t count){
+      struct i2c_rdwr_ioctl_data data = { &_msgs[2 * first], (uint32_t)(2 * count) };
+      bool ok = (_adapter->fd() >= 0) &&
+                (_adapter->ops().rdwr(_adapter->fd(), &data) == 2 * count);
+      for (uint8_t i = first; i < first + count; i++) {
+        _valid[i] = ok;
+        if (ok) {
+          _raw[i] = _rawBytes[i][0] | (uint16_t(_rawBytes[i][1]) << 8);
+          _convStep[i] = _sensors[i]->readConvStep();
+        }
+      }
+      return ok;
+    }
+
+    VEML6030LinuxI2C *_adapter;
+    uint8_t _count;
+    uint8_t _pointer;    // Register pointer byte shared by all pointer writes
+
+    SparkFun_Ambient_Light_A *_sensors[N];
+    struct i2c_msg _msgs[2 * N];
+    uint8_t _rawBytes[N][2];
+    uint16_t _raw[N];
+    uint8_t _convStep[N];
+    bool _valid[N];
+};
+
+#endif
+#endif
@@ -0,0 +1,267 @@
+/*
+  Adaptive power save for the SparkFun VEML6030 library, see
+  SparkFun_VEML6030_PowerControl.h.
+ */
+
+#include "SparkFun_VEML6030_PowerControl.h"
+
+// The default ladder, fastest first. 100ms without power save is left out, as
+// it draws as much as 50ms.
+static const VEML6030PowerLevel defaultLevels[] = {
+  { VEML6030::IntegTime::Ms50,  0 },
+  { VEML6030::IntegTime::Ms100, 1 },
+  { VEML6030::IntegTime::Ms100, 2 },
+  { VEML6030::IntegTime::Ms100, 3 },
+  { VEML6030::IntegTime::Ms100, 4 }
+};
+
+// The rate of change is measured between the means of windows at least this
+// long, so that the noise of samples taken 50ms apart does not read as a fast
+// change.
+static const uint16_t RATE_WINDOW_MS = 1000;
+
+VEML6030PowerPolicy::VEML6030PowerPolicy() :
+  levels(defaultLevels), levelCount(sizeof(defaultLevels) / sizeof(defaultLevels[0])),
+  jumpPermille(150), activePermille(50), calmPermille(10), calmMs(10000),
+  floorMilliLux(1000), intBandPermille(0) {}
+
+VEML6030PowerController::VEML6030PowerController(SparkFun_Ambient_Light_A &sensor)
+{
+
+  _sensor = &sensor;
+  _policy = 0;
+  _running = false;
+  _intPending = false;
+  _intEnabled = false;
+  _level = 0;
+  _milliLux = 0;
+  _rate = 0;
+  _writes = 0;
+  _chargeUAms = 0;
+
+}
+
+// This function starts the controller on the fastest level of the policy,
+// which has to outlive it. now is in milliseconds, usually millis().
+VEML6030_STATUS VEML6030PowerController::begin(const VEML6030PowerPolicy &policy, uint32_t now){
+
+  if (policy.levelCount == 0)
+    return VEML6030_INVALID_SETTING;
+
+  _policy = &policy;
+  _writes = 0;
+  _chargeUAms = 0;
+  _startedAt = now;
+  _haveLast = false;
+  _haveRef = false;
+  _refAt = now;
+  _windowSum = 0;
+  _windowCount = 0;
+  _rate = 0;
+  _intPending = false;
+  _intEnabled = false;
+
+  // Both registers are written once, whatever the sensor was set to before.
+  // The interrupt is only enabled once _armWindow() has put the thresholds
+  // around a reading.
+  const VEML6030PowerLevel &fastest = policy.levels[0];
+  VEML6030_STATUS status = _sensor->setIntegTime(VEML6030::refreshTimeMs(fastest.time, 0));
+  if (status == VEML6030_OK)
+    status = _sensor->setPowSave(fastest.psmMode);
+  if (status != VEML6030_OK)
+    return status;
+  _writes += 2;
+
+  _level = 0;
+  _levelSince = now;
+  _calmSince = now;
+  _sensor->startMeasurement(now);
+  _running = true;
+  return VEML6030_OK;
+
+}
+
+// This function stops the controller. The sensor keeps its level.
+void VEML6030PowerController::end(){
+
+  _running = false;
+
+}
+
+// This function reads the sensor when a new sample is due and moves to another
+// level if the policy says so.
+bool VEML6030PowerController::poll(uint32_t now){
+
+  if (!_running)
+    return false;
+
+  // An interrupt means the light left the window: no need to wait for the
+  // next sample to go fast. Reading the register clears the sensor's flag.
+  if (_intPending) {
+    _intPending = false;
+    _sensor->readInterrupt();
+    if (_level != 0)
+      _setLevel(0, now);
+    _calmSince = now;
+  }
+
+  if (!_sensor->poll(now))
+    return false;
+
+  uint16_t raw = _sensor->takeSampleRaw();
+  uint32_t milliLux = VEML6030::convertMilliLux(raw, _sensor->readConvStep());
+  const VEML6030PowerPolicy &policy = *_policy;
+
+  // A single sample far from the last one goes straight to the fastest level.
+  if (_haveLast) {
+    uint32_t base = (_milliLux > policy.floorMilliLux) ? _milliLux : policy.floorMilliLux;
+    uint32_t step = (milliLux > _milliLux) ? milliLux - _milliLux : _milliLux - milliLux;
+    if ((uint64_t)step * 1000 > (uint64_t)base * policy.jumpPermille) {
+      if (_level != 0)
+        _setLevel(0, now);
+      _calmSince = now;
+    }
+  }
+  _haveLast = true;
+  _milliLux = milliLux;
+
+  // The rate of change compares the mean of the samples in one window with
+  // the mean of the window before.
+  _windowSum += milliLux;
+  _windowCount++;
+  uint32_t elapsed = now - _refAt;
+  if (elapsed < RATE_WINDOW_MS)
+    return true;
+
+  uint32_t mean = _windowSum / _windowCount;
+  _windowSum = 0;
+  _windowCount = 0;
+  _refAt = now;
+  if (!_haveRef) {
+    _haveRef = true;
+    _refMilliLux = mean;
+    return true;
+  }
+
+  uint32_t base = (_refMilliLux > policy.floorMilliLux) ? _refMilliLux : policy.floorMilliLux;
+  uint32_t step = (mean > _refMilliLux) ? mean - _refMilliLux : _refMilliLux - mean;
+  float rate = 1000.0f * step / base * 1000 / elapsed;
+  _rate = (_rate + rate) / 2;
+  _refMilliLux = mean;
+
+  if (_rate >= policy.calmPermille)
+    _calmSince = now;
+
+  if (_rate > policy.activePermille && _level > 0)
+    _setLevel(0, now);
+  else if ((uint32_t)(now - _calmSince) >= policy.calmMs && _level + 1 < policy.levelCount) {
+    _setLevel(_level + 1, now);
+    _calmSince = now;
+  }
+
+  return true;
+
+}
+
+// This function returns when poll() will next read the sensor.
+uint32_t VEML6030PowerController::nextDueAt(){
+
+  return _sensor->nextSampleDueAt();
+
+}
+
+// This function returns the average current estimated from the time spent on
+// each level since begin(), in uA.
+float VEML6030PowerController::averageCurrentUA(uint32_t now){
+
+  if (!_policy)
+    return 0;
+
+  uint32_t total = now - _startedAt;
+  float charge = _chargeUAms + currentUA(_policy->levels[_level]) * (uint32_t)(now - _levelSince);
+  return total ? charge / total : currentUA(_policy->levels[_level]);
+
+}
+
+// This function returns the average supply current of a level in uA.
+float VEML6030PowerController::currentUA(const VEML6030PowerLevel &level){
+
+  uint16_t integ = VEML6030::refreshTimeMs(level.time, 0);
+  uint16_t wait = VEML6030::refreshTimeMs(level.time, level.psmMode) - integ;
+  return (45.0f * integ + 0.5f * wait) / (integ + wait);
+
+}
+
+// This function returns the reaction latency of a level in ms.
+uint32_t VEML6030PowerController::reactionMs(const VEML6030PowerLevel &level){
+
+  uint32_t refresh = VEML6030::refreshTimeMs(level.time, level.psmMode);
+  return refresh + VEML6030::settleTimeMs(refresh, VEML6030::refreshTimeMs(level.time, 0));
+
+}
+
+// This function moves to another level, writing only the registers that
+// differ. On a bus error the level is not changed and an integration time
+// already written is put back, so the sensor stays on the level level()
+// reports and a later sample tries the writes again. Should putting it back
+// fail as well, that next try writes it again.
+VEML6030_STATUS VEML6030PowerController::_setLevel(uint8_t _next, uint32_t _now){
+
+  const VEML6030PowerLevel &from = _policy->levels[_level];
+  const VEML6030PowerLevel &to = _policy->levels[_next];
+  bool timeWritten = false;
+
+  if (to.time != from.time) {
+    VEML6030_STATUS status = _sensor->setIntegTime(VEML6030::refreshTimeMs(to.time, 0));
+    if (status != VEML6030_OK)
+      return status;
+    _writes++;
+    timeWritten = true;
+  }
+  if (to.psmMode != from.psmMode) {
+    VEML6030_STATUS status = _sensor->setPowSave(to.psmMode);
+    if (status != VEML6030_OK) {
+      if (timeWritten && _sensor->setIntegTime(VEML6030::refreshTimeMs(from.time, 0)) == VEML6030_OK)
+        _writes++;
+      return status;
+    }
+    _writes++;
+  }
+
+  _chargeUAms += currentUA(from) * (uint32_t)(_now - _levelSince);
+  _levelSince = _now;
+  bool slower = _next > _level;
+  _level = _next;
+
+  if (slower && _policy->intBandPermille && to.psmMode)
+    _armWindow();
+  return VEML6030_OK;
+
+}
+
+// This function puts the sensor's threshold window around the last sample and,
+// the first time both thresholds are written, enables the interrupt.
+void VEML6030PowerController::_armWindow(){
+
+  uint32_t band = (uint64_t)_milliLux * _policy->intBandPermille / 1000;
+  uint32_t low = (_milliLux > band) ? (_milliLux - band) / 1000 : 0;
+  uint32_t high = (_milliLux + band + 999) / 1000;
+  if (high > 120000)
+    high = 120000;
+
+  bool armed = true;
+  if (_sensor->setIntLowThresh(low) == VEML6030_OK)
+    _writes++;
+  else
+    armed = false;
+  if (_sensor->setIntHighThresh(high) == VEML6030_OK)
+    _writes++;
+  else
+    armed = false;
+
+  if (armed && !_intEnabled && _sensor->enableInt() == VEML6030_OK) {
+    _writes++;
+    _intEnabled = true;
+  }
+
+}
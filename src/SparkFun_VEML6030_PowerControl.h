@@ -0,0 +1,140 @@
+#ifndef _SPARKFUN_VEML6030_POWERCONTROL_H_
+#define _SPARKFUN_VEML6030_POWERCONTROL_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+// One step of a power policy: an integration time and a power save mode
+// (0 = off, 1 - 4).
+struct VEML6030PowerLevel
+{
+  VEML6030::IntegTime time;
+  uint8_t psmMode;
+};
+
+// How VEML6030PowerController moves between levels. The levels run from the
+// fastest refresh to the slowest. Light changes are measured relative to the
+// light level, but never relative to less than floorMilliLux, so that noise in
+// the dark does not count as change.
+struct VEML6030PowerPolicy
+{
+  const VEML6030PowerLevel *levels;
+  uint8_t levelCount;
+  uint16_t jumpPermille;      // One sample this far from the last: fastest level
+  uint16_t activePermille;    // Smoothed change per second above this: fastest level
+  uint16_t calmPermille;      // Smoothed change per second below this...
+  uint32_t calmMs;            // ...for this long: one level slower
+  uint32_t floorMilliLux;
+  uint16_t intBandPermille;   // Threshold window armed on the slower levels, 0 = none
+
+  // The default ladder goes from 50ms without power save (20 samples a
+  // second, 45uA) to 100ms in mode 4 (one sample every 4.1s, 1.6uA).
+  VEML6030PowerPolicy();
+};
+
+// Adaptive power save: reads the sensor without blocking and picks the power
+// save mode and integration time from how fast the light changes. While the
+// scene is stable the controller steps one level slower every calmMs; as soon
+// as a sample jumps, the smoothed rate of change rises, or an interrupt is
+// reported, it goes straight back to the fastest level. A level change is one
+// write of POWER_SAVE_REG when only the power save mode changes and one write
+// of SETTING_REG when only the integration time does, with the shadow cache
+// on (enableShadowCache()); nothing is written while the level stays. The
+// gain is left as it is.
+//
+// With intBandPermille set, the sensor's threshold window is put around the
+// light level each time the controller settles on a slower level, so the
+// interrupt pin can wake a sleeping host when the light leaves the band; pass
+// it on with notifyInterrupt(). That costs two more writes per step down, and
+// one the first time, as the interrupt is only enabled once the thresholds
+// are set around a reading.
+// The sensor's auto-range, event mode and HDR must not be used at the same
+// time.
+//
+// The current estimates follow the datasheet: about 45uA while converting
+// and 0.5uA during the power save wait, so a level draws
+// (45 * integration time + 0.5 * wait) / (integration time + wait) uA.
+class VEML6030PowerController
+{
+  public:
+
+    VEML6030PowerController(SparkFun_Ambient_Light_A &sensor);
+
+    // This function starts the controller on the fastest level of the policy,
+    // which has to outlive it. now is in milliseconds, usually millis().
+    VEML6030_STATUS begin(const VEML6030PowerPolicy &policy, uint32_t now);
+
+    // This function stops the controller. The sensor keeps its level.
+    void end();
+
+    // This function reads the sensor when a new sample is due and moves to
+    // another level if the policy says so. Returns true when a new sample is
+    // available from milliLux().
+    bool poll(uint32_t now);
+
+    // This function returns when poll() will next read the sensor.
+    uint32_t nextDueAt();
+
+    // This function can be called from the interrupt routine of the sensor's
+    // INT pin. The next poll() clears the sensor's flag and goes to the
+    // fastest level.
+    void notifyInterrupt(){ _intPending = true; }
+
+    // These functions return the last sample, in milli-lux with the
+    // compensation formula applied above 1000 lux like readLightMilliLux(),
+    // and in lux.
+    uint32_t milliLux(){ return _milliLux; }
+    uint32_t lux(){ return _milliLux / 1000; }
+
+    // This function returns the smoothed change of the light, in permille of
+    // the light level per second.
+    float changePermillePerSec(){ return _rate; }
+
+    // This function returns the index of the level in use, 0 being the
+    // fastest.
+    uint8_t level(){ return _level; }
+
+    // This function returns the number of register writes the controller has
+    // made since begin().
+    uint32_t writes(){ return _writes; }
+
+    // This function returns the average current estimated from the time spent
+    // on each level since begin(), in uA.
+    float averageCurrentUA(uint32_t now);
+
+    // These functions return the estimates for one level: the average supply
+    // current in uA, and the reaction latency in ms, the longest it takes
+    // from a change of the light to reading a sample taken wholly after it:
+    // one refresh period, as the conversion running at the change is partly
+    // before it, plus VEML6030::settleTimeMs() of the level, as after a level
+    // change the reads may trail the conversions by up to a refresh period.
+    static float currentUA(const VEML6030PowerLevel &level);
+    static uint32_t reactionMs(const VEML6030PowerLevel &level);
+
+  private:
+
+    VEML6030_STATUS _setLevel(uint8_t _next, uint32_t _now);
+    void _armWindow();
+
+    SparkFun_Ambient_Light_A *_sensor;
+    const VEML6030PowerPolicy *_policy;
+
+    bool _running;
+    volatile bool _intPending;
+    bool _intEnabled;         // Set once _armWindow() has enabled the interrupt
+    uint8_t _level;
+    uint32_t _levelSince;     // When the current level was set
+    uint32_t _calmSince;      // Start of the current calm stretch
+    bool _haveLast;
+    bool _haveRef;
+    uint32_t _refAt;          // Start of the rate window
+    uint32_t _refMilliLux;    // Mean of the window before
+    uint64_t _windowSum;
+    uint16_t _windowCount;
+    uint32_t _milliLux;
+    float _rate;
+
+    uint32_t _writes;
+    uint32_t _startedAt;
+    float _chargeUAms;        // Current times time of the levels left so far
+};
+#endif
@@ -0,0 +1,139 @@
+/*
+  This is the reading publisher of the SparkFun VEML6030 library, for hosted
+  builds where one thread owns the sensor and others want its latest reading.
+ */
+
+#include "SparkFun_VEML6030_Publisher.h"
+
+#if !defined(ARDUINO)
+
+#include <string.h>
+
+VEML6030Publisher::VEML6030Publisher() : _sequence(0)
+{
+
+  // Slot 0 holds an all zero reading, i.e. sequence 0: nothing published.
+  for (uint8_t i = 0; i < SLOTS; i++) {
+    _slots[i].seq.store(0, std::memory_order_relaxed);
+    for (uint8_t w = 0; w < WORDS; w++)
+      _slots[i].words[w].store(0, std::memory_order_relaxed);
+  }
+
+}
+
+// Owner thread only. This function reads the sensor with readSnapshot() and
+// publishes the result with the sensor's settings and the given time. With
+// the shadow cache on (enableShadowCache()) the settings cost no transfers,
+// leaving the three register reads of readSnapshot(). Nothing is published
+// on a bus error, so readers keep the last good reading and can tell its age
+// from the timestamp.
+VEML6030_STATUS VEML6030Publisher::publish(SparkFun_Ambient_Light_A &sensor, uint32_t now)
+{
+
+  VEML6030Published reading;
+  memset(&reading, 0, sizeof(reading));
+
+  VEML6030_STATUS status = sensor.readSnapshot(reading.snapshot);
+  if (status != VEML6030_OK)
+    return status;
+
+  reading.timestamp = now;
+  reading.gain = sensor.readGain();
+  reading.integTime = sensor.readIntegTime();
+  reading.powSavMode = sensor.readPowSavEnabled() ? sensor.readPowSavMode() : 0;
+  reading.convStep = sensor.readConvStep();
+  if ((status = sensor.lastStatus()) != VEML6030_OK)
+    return status;
+
+  publish(reading);
+  return VEML6030_OK;
+
+}
+
+// Owner thread only. This function publishes the given reading. Its sequence
+// is ignored and replaced with the next one.
+void VEML6030Publisher::publish(const VEML6030Published &reading)
+{
+
+  uint32_t words[WORDS] = { 0 };
+  memcpy(words, &reading, sizeof(reading));
+  uint32_t sequence = _sequence.load(std::memory_order_relaxed) + 1;
+  if (sequence == 0)
+    sequence = 1; // 0 means nothing published
+  memcpy(words, &sequence, sizeof(sequence)); // sequence is the first field
+
+  _Slot &slot = _slots[sequence % SLOTS];
+
+  // Mark the slot as being written before any word of it changes...
+  uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+  slot.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (uint8_t w = 0; w < WORDS; w++)
+    slot.words[w].store(words[w], std::memory_order_relaxed);
+
+  // ...and as complete once they all have, then hand it to the readers.
+  slot.seq.store(seq + 2, std::memory_order_release);
+  _sequence.store(sequence, std::memory_order_release);
+
+}
+
+// The copy is good if the slot was not being written meanwhile and still
+// holds the reading that was the latest when the copy started. A slot the
+// owner has lapped meanwhile holds a newer one, which is turned down, as a
+// later copy could be of the latest again and so go back in time.
+bool VEML6030Publisher::_readLatest(VEML6030Published &_reading) const
+{
+
+  uint32_t latest = _sequence.load(std::memory_order_acquire);
+  const _Slot &slot = _slots[latest % SLOTS];
+
+  uint32_t before = slot.seq.load(std::memory_order_acquire);
+  if (before & 1)
+    return false;
+
+  uint32_t words[WORDS];
+  for (uint8_t w = 0; w < WORDS; w++)
+    words[w] = slot.words[w].load(std::memory_order_relaxed);
+
+  // The copy has to be complete before the counter is looked at again.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.seq.load(std::memory_order_relaxed) != before || words[0] != latest)
+    return false;
+
+  memcpy(&_reading, words, sizeof(_reading));
+  return true;
+
+}
+
+// Any thread. This function copies the latest reading. Returns false if
+// nothing has been published yet.
+bool VEML6030Publisher::read(VEML6030Published &reading) const
+{
+
+  while (!_readLatest(reading))
+    ;
+  return reading.sequence != 0;
+
+}
+
+// Any thread. This function makes one attempt to copy the latest reading.
+// Returns false if nothing has been published yet or the owner overwrote the
+// slot during the copy.
+bool VEML6030Publisher::tryRead(VEML6030Published &reading) const
+{
+
+  return _readLatest(reading) && reading.sequence != 0;
+
+}
+
+// Any thread. This function returns the sequence of the latest reading, 0 if
+// none, as a cheap check for something new.
+uint32_t VEML6030Publisher::sequence() const
+{
+
+  return _sequence.load(std::memory_order_acquire);
+
+}
+
+#endif
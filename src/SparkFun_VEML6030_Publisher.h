@@ -0,0 +1,88 @@
+#ifndef _SPARKFUN_VEML6030_PUBLISHER_H_
+#define _SPARKFUN_VEML6030_PUBLISHER_H_
+
+// The publisher needs std::atomic and threads to be of any use, so it is only
+// built on hosted platforms; Arduino builds leave it out.
+#if !defined(ARDUINO)
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include <atomic>
+
+// One published reading with the settings it was taken with.
+struct VEML6030Published
+{
+  uint32_t sequence;         // 1 for the first publish, counting up; 0 before any
+  uint32_t timestamp;        // Clock value given to publish(), usually millis()
+  VEML6030Snapshot snapshot; // Raw counts, lux and interrupt, as readSnapshot()
+  float gain;                // .125, .25, 1 or 2
+  uint16_t integTime;        // 25 - 800 ms
+  uint8_t powSavMode;        // 1 - 4, 0 when power save mode is off
+  uint8_t convStep;          // See VEML6030::rawToMilliLux()
+};
+
+// Shares the latest reading of one sensor between threads. A single owner
+// thread talks to the sensor and publishes; any number of other threads read
+// the latest reading without touching the bus or taking a lock. Only the
+// owner may use the sensor object, its transport and TwoWire port: they are
+// not thread safe.
+//
+// The reading is kept in four slots, each guarded by a sequence counter (a
+// seqlock). The owner writes the slot after the latest one and then points
+// readers at it, so a reader copying the latest slot is only disturbed if
+// the owner publishes four more times during one 32 byte copy. tryRead() is
+// a single attempt and so wait-free; read() retries in that case. A reader
+// never sees an older reading after a newer one. Readers never write shared
+// memory, so they do not slow each other or the owner down.
+class VEML6030Publisher
+{
+  public:
+
+    VEML6030Publisher();
+
+    // Owner thread only. This function reads the sensor with readSnapshot()
+    // and publishes the result with the sensor's settings and the given time.
+    // With the shadow cache on (enableShadowCache()) the settings cost no
+    // transfers, leaving the three register reads of readSnapshot(). Nothing
+    // is published on a bus error, so readers keep the last good reading and
+    // can tell its age from the timestamp.
+    VEML6030_STATUS publish(SparkFun_Ambient_Light_A &sensor, uint32_t now);
+
+    // Owner thread only. This function publishes the given reading. Its
+    // sequence is ignored and replaced with the next one.
+    void publish(const VEML6030Published &reading);
+
+    // Any thread. This function copies the latest reading. Returns false if
+    // nothing has been published yet.
+    bool read(VEML6030Published &reading) const;
+
+    // Any thread. This function makes one attempt to copy the latest reading.
+    // Returns false if nothing has been published yet or the owner overwrote
+    // the slot during the copy.
+    bool tryRead(VEML6030Published &reading) const;
+
+    // Any thread. This function returns the sequence of the latest reading,
+    // 0 if none, as a cheap check for something new.
+    uint32_t sequence() const;
+
+    static const uint8_t SLOTS = 4;
+
+  private:
+
+    static const uint8_t WORDS = (sizeof(VEML6030Published) + 3) / 4;
+
+    // Each slot on its own cache line, so the owner writing one slot does
+    // not disturb readers copying another.
+    struct alignas(64) _Slot
+    {
+      std::atomic<uint32_t> seq;   // Odd while the owner writes the slot
+      std::atomic<uint32_t> words[WORDS];
+    };
+
+    bool _readLatest(VEML6030Published &_reading) const;
+
+    _Slot _slots[SLOTS];
+    alignas(64) std::atomic<uint32_t> _sequence;   // Latest; its slot is _sequence % SLOTS
+};
+
+#endif
+#endif
@@ -0,0 +1,237 @@
+#ifndef _SPARKFUN_VEML6030_SAMPLE_BUFFER_H_
+#define _SPARKFUN_VEML6030_SAMPLE_BUFFER_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+
+// One stored reading: the raw count, the conversion step it was taken with and
+// the time it was taken. Conversion to lux only happens when asked for.
+struct VEML6030RawSample
+{
+  uint32_t timestamp;
+  uint16_t raw;
+  uint8_t convStep;
+
+  // This function converts the sample like readLightMilliLux().
+  uint32_t milliLux() const { return VEML6030::convertMilliLux(raw, convStep); }
+
+  // This function returns the sample in units of the finest resolution, .0036
+  // lux, so samples taken with different settings can be compared without
+  // any multiplication. This is what the statistics are kept in.
+  uint32_t normalized() const { return (convStep > 9) ? 0 : (uint32_t)raw << convStep; }
+};
+
+// A ring buffer of the last CAPACITY samples, statically sized, with
+// statistics kept up to date as samples are added. Storing a sample is a store
+// of a few bytes plus some integer additions and compares, in O(1); nothing is
+// converted to lux, and no floating point is used, until it is read back.
+//
+// Two sets of statistics are kept, both on uncompensated values:
+// * Stream statistics over every sample since the last clear(): count, min,
+//   max, and exact integer sums from which the mean and variance are worked
+//   out when asked for. The sum of squares takes up to 82 bits, so it is kept
+//   in two parts.
+// * Window statistics over the samples currently held: mean and variance from
+//   exact integer sums, min and max cached. Only when the sample that was the
+//   min or max leaves the window is the buffer scanned again, by the next
+//   call that asks for it.
+template <uint16_t CAPACITY>
+class VEML6030SampleBuffer
+{
+    // Keeps the window sums and the variance numerator within 64 bits.
+    static_assert(CAPACITY >= 1 && CAPACITY <= 4096, "VEML6030SampleBuffer holds 1 to 4096 samples");
+
+  public:
+
+    VEML6030SampleBuffer(){ clear(); }
+
+    // This function empties the buffer and resets all statistics.
+    void clear(){
+      _head = 0;
+      _size = 0;
+      _windowSum = 0;
+      _windowSumSq = 0;
+      _windowMin = 0xFFFFFFFF;
+      _windowMax = 0;
+      _windowMinValid = true;
+      _windowMaxValid = true;
+      _streamCount = 0;
+      _streamMin = 0xFFFFFFFF;
+      _streamMax = 0;
+      _streamSum = 0;
+      _streamSumSq = 0;
+      _streamSumSqHigh = 0;
+    }
+
+    // This function reads the sensor's raw ambient light count and stores it.
+    // It is the only bus transaction involved while the sensor's conversion
+    // step is known. Nothing is stored if the read fails.
+    VEML6030_STATUS sample(SparkFun_Ambient_Light_A &sensor, uint32_t now){
+      uint16_t raw;
+      VEML6030_STATUS status = sensor.readLightRaw(raw);
+      if (status != VEML6030_OK)
+        return status;
+      uint8_t convStep = sensor.readConvStep();
+      if (convStep == VEML6030::CONV_STEP_INVALID)
+        return VEML6030_BUS_ERROR;
+      push(now, raw, convStep);
+      return VEML6030_OK;
+    }
+
+    // This function stores a sample, replacing the oldest one once the buffer
+    // is full.
+    void push(uint32_t timestamp, uint16_t raw, uint8_t convStep){
+      VEML6030RawSample &slot = _samples[_head];
+
+      if (_size == CAPACITY) {
+        uint32_t old = slot.normalized();
+        _windowSum -= old;
+        _windowSumSq -= (uint64_t)old * old;
+        if (old == _windowMin)
+          _windowMinValid = false;
+        if (old == _windowMax)
+          _windowMaxValid = false;
+      }
+      else
+        _size++;
+
+      slot.timestamp = timestamp;
+      slot.raw = raw;
+      slot.convStep = convStep;
+      _head = (_head + 1 == CAPACITY) ? 0 : _head + 1;
+
+      uint32_t value = slot.normalized();
+      uint64_t square = (uint64_t)value * value;
+      _windowSum += value;
+      _windowSumSq += square;
+
+      // The cached extremes stay bounds of the window even once the sample
+      // they came from has left it, so a new sample beyond them is exact.
+      if (value <= _windowMin) {
+        _windowMin = value;
+        _windowMinValid = true;
+      }
+      if (value >= _windowMax) {
+        _windowMax = value;
+        _windowMaxValid = true;
+      }
+
+      _streamCount++;
+      if (value < _streamMin)
+        _streamMin = value;
+      if (value > _streamMax)
+        _streamMax = value;
+      _streamSum += value;
+      _streamSumSq += square;
+      if (_streamSumSq < square)
+        _streamSumSqHigh++;
+    }
+
+    // These functions give access to the stored samples without copying them.
+    // Index 0 is the oldest sample, size() - 1 the newest.
+    uint16_t size() const { return _size; }
+    uint16_t capacity() const { return CAPACITY; }
+    bool isFull() const { return _size == CAPACITY; }
+    const VEML6030RawSample &operator[](uint16_t i) const {
+      uint16_t pos = _head + (CAPACITY - _size) + i;
+      return _samples[pos >= CAPACITY ? pos - CAPACITY : pos];
+    }
+    const VEML6030RawSample &newest() const { return (*this)[_size - 1]; }
+
+    // Stream statistics in lux, since the last clear().
+    uint32_t count() const { return _streamCount; }
+    float minLux() const { return _streamCount ? _streamMin * LUX_PER_UNIT : 0; }
+    float maxLux() const { return _streamMax * LUX_PER_UNIT; }
+    float meanLux() const {
+      return _streamCount ? (float)_streamSum / _streamCount * LUX_PER_UNIT : 0;
+    }
+    float varianceLux() const {
+      if (_streamCount < 2)
+        return 0;
+      return _sumOfSquares(_streamSumSqHigh, _streamSumSq, _streamSum, _streamCount) /
+             (_streamCount - 1) * LUX_PER_UNIT * LUX_PER_UNIT;
+    }
+
+    // Window statistics in lux, over the samples currently in the buffer.
+    float windowMeanLux() const {
+      return _size ? (float)_windowSum / _size * LUX_PER_UNIT : 0;
+    }
+    float windowVarianceLux() const {
+      if (_size < 2)
+        return 0;
+      return _sumOfSquares(0, _windowSumSq, _windowSum, _size) / (_size - 1) * LUX_PER_UNIT * LUX_PER_UNIT;
+    }
+    float windowMinLux() const {
+      if (!_windowMinValid)
+        _rescanWindow();
+      return _size ? _windowMin * LUX_PER_UNIT : 0;
+    }
+    float windowMaxLux() const {
+      if (!_windowMaxValid)
+        _rescanWindow();
+      return _windowMax * LUX_PER_UNIT;
+    }
+
+  private:
+
+    static constexpr float LUX_PER_UNIT = .0036f;
+
+    // This function returns sumSq - sum^2 / n, the sum of the squared
+    // deviations from the mean, worked out in integers from the exact sums so
+    // there is neither drift nor cancellation; sumSq is given as its bits
+    // above and below bit 64. With sum = q * n + r, sum^2 / n is
+    // q * sum + q * r + r^2 / n, where only q * sum can take more than 64 bits.
+    static float _sumOfSquares(uint32_t sumSqHigh, uint64_t sumSq, uint64_t sum, uint32_t n){
+      uint64_t q = sum / n;
+      uint64_t r = sum % n;
+
+      // q * sum from the products with the two 32 bit halves of sum.
+      uint64_t low = q * (uint32_t)sum;
+      uint64_t mid = q * (sum >> 32);
+      uint64_t productLow = low + (mid << 32);
+      uint64_t productHigh = (mid >> 32) + (productLow < low);
+
+      uint64_t rest = q * r + r * r / n;
+      uint64_t resultLow = sumSq - productLow;
+      uint64_t resultHigh = sumSqHigh - productHigh - (sumSq < productLow);
+      resultHigh -= (resultLow < rest);
+      resultLow -= rest;
+      return (float)resultHigh * 18446744073709551616.0f + (float)resultLow;
+    }
+
+    // This function finds the window's min and max again after one of them
+    // left it.
+    void _rescanWindow() const {
+      _windowMin = 0xFFFFFFFF;
+      _windowMax = 0;
+      for (uint16_t i = 0; i < _size; i++) {
+        uint32_t value = (*this)[i].normalized();
+        if (value < _windowMin)
+          _windowMin = value;
+        if (value > _windowMax)
+          _windowMax = value;
+      }
+      _windowMinValid = true;
+      _windowMaxValid = true;
+    }
+
+    VEML6030RawSample _samples[CAPACITY];
+    uint16_t _head;    // Slot the next sample goes into
+    uint16_t _size;
+
+    uint64_t _windowSum;
+    uint64_t _windowSumSq;
+    // Bounds of the window's values, exact while valid. Queries rescan the
+    // buffer when they are not, hence mutable.
+    mutable uint32_t _windowMin;
+    mutable uint32_t _windowMax;
+    mutable bool _windowMinValid;
+    mutable bool _windowMaxValid;
+
+    uint32_t _streamCount;
+    uint32_t _streamMin;
+    uint32_t _streamMax;
+    uint64_t _streamSum;        // Up to 2^57: 2^32 samples below 2^25
+    uint64_t _streamSumSq;      // Low 64 bits of the sum of squares
+    uint32_t _streamSumSqHigh;  // and the bits above them
+};
+#endif
@@ -0,0 +1,326 @@
+/*
+  This is the background sampling service of the SparkFun VEML6030 library,
+  for hosted builds: a hashed timer wheel and one worker thread per I2C bus.
+ */
+
+#include "SparkFun_VEML6030_Service.h"
+
+#if !defined(ARDUINO)
+
+#include <chrono>
+
+VEML6030TimerWheel::VEML6030TimerWheel(uint32_t now) : _now(now), _size(0)
+{
+
+  for (uint16_t i = 0; i < SLOTS; i++)
+    _slots[i] = 0;
+  for (uint16_t i = 0; i < WORDS; i++)
+    _occupied[i] = 0;
+
+}
+
+// This function (re)schedules a timer. A time already passed makes it due on
+// the next advance().
+void VEML6030TimerWheel::schedule(Timer &timer, uint32_t dueAt)
+{
+
+  if (timer.scheduled)
+    cancel(timer);
+
+  if ((int32_t)(dueAt - _now) < 1)
+    dueAt = _now + 1;
+  else if (dueAt - _now > SLOTS)
+    dueAt = _now + SLOTS;
+
+  uint16_t slot = dueAt & MASK;
+  timer.dueAt = dueAt;
+  timer.prev = 0;
+  timer.next = _slots[slot];
+  if (timer.next)
+    timer.next->prev = &timer;
+  _slots[slot] = &timer;
+  _occupied[slot >> 6] |= 1ULL << (slot & 63);
+  timer.scheduled = true;
+  _size++;
+
+}
+
+// This function removes a scheduled timer.
+void VEML6030TimerWheel::cancel(Timer &timer)
+{
+
+  if (!timer.scheduled)
+    return;
+
+  uint16_t slot = timer.dueAt & MASK;
+  if (timer.prev)
+    timer.prev->next = timer.next;
+  else
+    _slots[slot] = timer.next;
+  if (timer.next)
+    timer.next->prev = timer.prev;
+  if (!_slots[slot])
+    _occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+  timer.scheduled = false;
+  _size--;
+
+}
+
+// Distance in slots from the slot after _now to the next occupied one, or
+// SLOTS if there is none.
+uint16_t VEML6030TimerWheel::_nextOccupied()
+{
+
+  uint16_t start = (_now + 1) & MASK;
+  uint16_t word = start >> 6;
+  uint64_t bits = _occupied[word] & (~0ULL << (start & 63));
+
+  // Once round the wheel, ending with the bits of the first word below
+  // start.
+  for (uint16_t i = 0; i <= WORDS; i++) {
+    if (bits) {
+      uint16_t slot = (word << 6) + __builtin_ctzll(bits);
+      return (slot - start) & MASK;
+    }
+    word = (word + 1) % WORDS;
+    bits = _occupied[word];
+  }
+  return SLOTS;
+
+}
+
+// This function moves the wheel on to now and returns every timer that is now
+// due as a list linked through next, in order of due time. They are no longer
+// scheduled, so they can be rescheduled while walking the list if next is
+// read first.
+VEML6030TimerWheel::Timer *VEML6030TimerWheel::advance(uint32_t now)
+{
+
+  Timer *due = 0;
+  Timer **tail = &due;
+
+  while ((int32_t)(now - _now) > 0) {
+    uint16_t skip = _nextOccupied();
+    if (skip >= SLOTS || (int32_t)(now - (_now + 1 + skip)) < 0) {
+      _now = now;
+      break;
+    }
+
+    // Every timer in the slot is due: none is further than one turn ahead.
+    _now += 1 + skip;
+    uint16_t slot = _now & MASK;
+    for (Timer *timer = _slots[slot]; timer; timer = timer->next) {
+      timer->scheduled = false;
+      timer->prev = 0;
+      _size--;
+      *tail = timer;
+      tail = &timer->next;
+    }
+    _slots[slot] = 0;
+    _occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+  }
+
+  return due;
+
+}
+
+// This function gives the due time of the earliest timer. Returns false if no
+// timer is scheduled.
+bool VEML6030TimerWheel::nextDueAt(uint32_t &dueAt)
+{
+
+  uint16_t skip = _nextOccupied();
+  if (skip >= SLOTS)
+    return false;
+  dueAt = _now + 1 + skip;
+  return true;
+
+}
+
+static uint32_t _millisClock()
+{
+
+  return millis();
+
+}
+
+VEML6030Service::VEML6030Service(uint32_t (*clock)()) :
+  _clock(clock ? clock : _millisClock), _running(false) {}
+
+VEML6030Service::~VEML6030Service()
+{
+
+  stop();
+
+}
+
+// This function adds a sensor on the given bus (0 to MAX_BUSES - 1, e.g. the
+// number of /dev/i2c-N). Sensors can only be added while the service is
+// stopped. Returns false if it is running or the bus number is out of range.
+bool VEML6030Service::add(SparkFun_Ambient_Light_A &sensor, uint8_t bus, Callback callback)
+{
+
+  if (_running || bus >= MAX_BUSES)
+    return false;
+
+  if (!_buses[bus])
+    _buses[bus].reset(new _Bus(_clock()));
+
+  _Entry entry;
+  entry.sensor = &sensor;
+  entry.callback = callback;
+  _buses[bus]->entries.push_back(entry);
+  return true;
+
+}
+
+// Without threads: begin() starts measuring on every sensor, then poll() does
+// one round of a bus worker's work at now: it reads every sensor on the bus
+// that is due and hands on the samples. It returns the time the next sensor
+// is due, for a caller running its own loop.
+void VEML6030Service::begin(uint32_t now)
+{
+
+  for (uint8_t b = 0; b < MAX_BUSES; b++) {
+    if (!_buses[b])
+      continue;
+    _Bus &bus = *_buses[b];
+    bus.wheel.advance(now);
+    for (size_t i = 0; i < bus.entries.size(); i++) {
+      _Entry &entry = bus.entries[i];
+      entry.sensor->startMeasurement(now);
+      bus.wheel.schedule(entry.timer, entry.sensor->nextSampleDueAt(now));
+    }
+  }
+
+}
+
+uint32_t VEML6030Service::poll(uint8_t bus, uint32_t now)
+{
+
+  return _poll(bus, now, false);
+
+}
+
+// With liveClock each sensor is read at the time taken from the clock just
+// before, rather than at now: with many sensors due at once, or slow
+// callbacks, the last ones are read well after now, and a sensor scheduled
+// from a read time that is too early would be due before its next
+// conversion.
+uint32_t VEML6030Service::_poll(uint8_t bus, uint32_t now, bool liveClock)
+{
+
+  if (bus >= MAX_BUSES || !_buses[bus])
+    return now + VEML6030TimerWheel::SLOTS;
+  _Bus &b = *_buses[bus];
+
+  VEML6030ServiceStats done = VEML6030ServiceStats();
+  VEML6030TimerWheel::Timer *timer = b.wheel.advance(now);
+  while (timer) {
+    VEML6030TimerWheel::Timer *next = timer->next;
+    _Entry &entry = *reinterpret_cast<_Entry *>(timer);
+    SparkFun_Ambient_Light_A &sensor = *entry.sensor;
+    if (liveClock)
+      now = _clock();
+
+    uint32_t late = now - timer->dueAt;
+    if (late > done.worstLateMs)
+      done.worstLateMs = late;
+    done.expired++;
+
+    if (sensor.poll(now)) {
+      VEML6030RawSample sample;
+      sample.timestamp = now;
+      sample.convStep = sensor.readConvStep();
+      sample.raw = sensor.takeSampleRaw();
+      if (entry.callback)
+        entry.callback(sensor, sample);
+      done.samples++;
+    }
+    // On the service clock: a sensor that has to restart its wait is polled
+    // again on the next tick.
+    b.wheel.schedule(*timer, sensor.nextSampleDueAt(now));
+    timer = next;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(b.statsLock);
+    b.stats.samples += done.samples;
+    b.stats.expired += done.expired;
+    b.stats.wakeups++;
+    if (done.worstLateMs > b.stats.worstLateMs)
+      b.stats.worstLateMs = done.worstLateMs;
+  }
+
+  uint32_t dueAt;
+  return b.wheel.nextDueAt(dueAt) ? dueAt : now + VEML6030TimerWheel::SLOTS;
+
+}
+
+// This function starts measuring on every sensor and one worker thread per
+// bus in use. Returns false if it is already running.
+bool VEML6030Service::start()
+{
+
+  if (_running)
+    return false;
+
+  begin(_clock());
+  _running = true;
+  for (uint8_t b = 0; b < MAX_BUSES; b++) {
+    if (_buses[b])
+      _buses[b]->worker = std::thread(&VEML6030Service::_work, this, b);
+  }
+  return true;
+
+}
+
+// This function stops and joins the workers. The sensors keep measuring;
+// start() picks them up again.
+void VEML6030Service::stop()
+{
+
+  {
+    std::lock_guard<std::mutex> lock(_wakeLock);
+    if (!_running)
+      return;
+    _running = false;
+  }
+  _wake.notify_all();
+
+  for (uint8_t b = 0; b < MAX_BUSES; b++) {
+    if (_buses[b] && _buses[b]->worker.joinable())
+      _buses[b]->worker.join();
+  }
+
+}
+
+// This function returns the work done on a bus. It can be called while the
+// service runs.
+VEML6030ServiceStats VEML6030Service::stats(uint8_t bus)
+{
+
+  if (bus >= MAX_BUSES || !_buses[bus])
+    return VEML6030ServiceStats();
+  std::lock_guard<std::mutex> lock(_buses[bus]->statsLock);
+  return _buses[bus]->stats;
+
+}
+
+void VEML6030Service::_work(uint8_t _bus)
+{
+
+  std::unique_lock<std::mutex> lock(_wakeLock);
+  while (_running) {
+    lock.unlock();
+    uint32_t dueAt = _poll(_bus, _clock(), true);
+    lock.lock();
+
+    int32_t wait = (int32_t)(dueAt - _clock());
+    if (wait > 0)
+      _wake.wait_for(lock, std::chrono::milliseconds(wait), [this]{ return !_running; });
+  }
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef _SPARKFUN_VEML6030_SERVICE_H_
+#define _SPARKFUN_VEML6030_SERVICE_H_
+
+// The sampling service runs its own threads, so it is only built on hosted
+// platforms; Arduino builds leave it out.
+#if !defined(ARDUINO)
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_SampleBuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// A hashed timer wheel with one slot per millisecond. Timers are intrusive,
+// so scheduling and cancelling are a few pointer writes with no allocation,
+// and expiring one costs the same however many are scheduled. Timers due
+// further ahead than one turn of the wheel (SLOTS ms) are clamped to the end
+// of the turn; every refresh time of the sensor fits in one turn, so every
+// timer found in a slot is due. A bitmap of occupied slots lets advance()
+// and nextDueAt() skip empty stretches 64 slots at a time. Not thread safe.
+class VEML6030TimerWheel
+{
+  public:
+
+    static const uint16_t SLOTS = 8192;
+
+    struct Timer
+    {
+      Timer *next;
+      Timer *prev;
+      uint32_t dueAt;
+      bool scheduled;
+
+      Timer() : next(0), prev(0), dueAt(0), scheduled(false) {}
+    };
+
+    // The wheel starts at the given time.
+    VEML6030TimerWheel(uint32_t now);
+
+    // This function (re)schedules a timer. A time already passed makes it due
+    // on the next advance().
+    void schedule(Timer &timer, uint32_t dueAt);
+
+    // This function removes a scheduled timer.
+    void cancel(Timer &timer);
+
+    // This function moves the wheel on to now and returns every timer that is
+    // now due as a list linked through next, in order of due time. They are
+    // no longer scheduled, so they can be rescheduled while walking the list
+    // if next is read first.
+    Timer *advance(uint32_t now);
+
+    // This function gives the due time of the earliest timer. Returns false if
+    // no timer is scheduled.
+    bool nextDueAt(uint32_t &dueAt);
+
+    // This function returns the number of timers scheduled.
+    uint32_t size(){ return _size; }
+
+  private:
+
+    static const uint16_t MASK = SLOTS - 1;
+    static const uint16_t WORDS = SLOTS / 64;
+
+    // Distance in slots from the slot after _now to the next occupied one,
+    // or SLOTS if there is none.
+    uint16_t _nextOccupied();
+
+    Timer *_slots[SLOTS];
+    uint64_t _occupied[WORDS];
+    uint32_t _now;   // Every slot up to and including this time is done
+    uint32_t _size;
+};
+
+// Work done by one bus worker since start.
+struct VEML6030ServiceStats
+{
+  uint64_t samples;      // Samples handed to callbacks
+  uint64_t expired;      // Timers expired, each one poll() of a sensor
+  uint64_t wakeups;      // Calls of VEML6030Service::poll()
+  uint32_t worstLateMs;  // Longest a timer waited past its due time
+};
+
+// Samples many sensors in the background, each exactly once per conversion.
+// Sensors are grouped by I2C bus; each bus gets one worker thread, which
+// keeps every sensor's next due time on the service's clock
+// (SparkFun_Ambient_Light_A::nextSampleDueAt(now)) in a VEML6030TimerWheel
+// and sleeps until the earliest.
+// When a sensor is due the worker calls its poll(), which reads the ambient
+// light register once, and hands the sample to the sensor's callback. A
+// sensor with nothing new is never touched, and the scheduling cost per
+// sample does not grow with the number of sensors.
+//
+// Sensors have to be started (begin()) on their transport before they are
+// added, and while the service runs only their bus worker may use them. The
+// callback runs on the worker thread; a slow callback delays the other
+// sensors on its bus. Sensors on different buses never wait for each other.
+class VEML6030Service
+{
+  public:
+
+    typedef void (*Callback)(SparkFun_Ambient_Light_A &sensor, const VEML6030RawSample &sample);
+
+    static const uint8_t MAX_BUSES = 16;
+
+    // The service uses millis() unless given another clock in ms.
+    VEML6030Service(uint32_t (*clock)() = 0);
+    ~VEML6030Service();
+
+    // This function adds a sensor on the given bus (0 to MAX_BUSES - 1, e.g.
+    // the number of /dev/i2c-N). Sensors can only be added while the service
+    // is stopped. Returns false if it is running or the bus number is out of
+    // range.
+    bool add(SparkFun_Ambient_Light_A &sensor, uint8_t bus, Callback callback);
+
+    // This function starts measuring on every sensor and one worker thread
+    // per bus in use. Returns false if it is already running.
+    bool start();
+
+    // This function stops and joins the workers. The sensors keep measuring;
+    // start() picks them up again.
+    void stop();
+
+    bool isRunning(){ return _running; }
+
+    // Without threads: begin() starts measuring on every sensor, then poll()
+    // does one round of a bus worker's work at now: it reads every sensor on
+    // the bus that is due and hands on the samples. It returns the time the
+    // next sensor is due, for a caller running its own loop.
+    void begin(uint32_t now);
+    uint32_t poll(uint8_t bus, uint32_t now);
+
+    // This function returns the work done on a bus. It can be called while
+    // the service runs.
+    VEML6030ServiceStats stats(uint8_t bus);
+
+  private:
+
+    // The timer comes first, so a Timer * from the wheel is its _Entry.
+    struct _Entry
+    {
+      VEML6030TimerWheel::Timer timer;
+      SparkFun_Ambient_Light_A *sensor;
+      Callback callback;
+    };
+
+    struct _Bus
+    {
+      _Bus(uint32_t now) : wheel(now) {}
+
+      VEML6030TimerWheel wheel;
+      std::deque<_Entry> entries;   // A deque never moves its elements
+      std::thread worker;
+      std::mutex statsLock;
+      VEML6030ServiceStats stats = VEML6030ServiceStats();
+    };
+
+    uint32_t _poll(uint8_t bus, uint32_t now, bool liveClock);
+    void _work(uint8_t _bus);
+
+    uint32_t (*_clock)();
+    std::unique_ptr<_Bus> _buses[MAX_BUSES];
+    std::atomic<bool> _running;
+    std::mutex _wakeLock;
+    std::condition_variable _wake;
+};
+
+#endif
+#endif
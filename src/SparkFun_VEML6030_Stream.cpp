@@ -0,0 +1,213 @@
+/*
+  Change detection and a compact block format for sending VEML6030 samples
+  over slow links, see SparkFun_VEML6030_Stream.h.
+ */
+
+#include "SparkFun_VEML6030_Stream.h"
+
+VEML6030ChangeFilter::VEML6030ChangeFilter(uint32_t absMilliLux, uint16_t relPerMille,
+                                           uint32_t maxSilenceMs)
+{
+
+  setDeadband(absMilliLux, relPerMille); 
+  setMaxSilence(maxSilenceMs); 
+  _hasSent = false; 
+  _last.timestamp = 0; 
+  _last.raw = 0; 
+  _last.convStep = VEML6030::CONV_STEP_INVALID; 
+
+}
+
+// These functions change the deadband and the maximum silence interval
+// (0 for none). 
+void VEML6030ChangeFilter::setDeadband(uint32_t absMilliLux, uint16_t relPerMille){
+
+  _absMilliLux = absMilliLux; 
+  _relPerMille = relPerMille; 
+
+}
+
+void VEML6030ChangeFilter::setMaxSilence(uint32_t maxSilenceMs){
+
+  _maxSilenceMs = maxSilenceMs; 
+
+}
+
+// This function checks a sample and returns true if it passes. 
+bool VEML6030ChangeFilter::accept(const VEML6030RawSample &sample){
+
+  uint32_t milliLux = sample.milliLux(); 
+  bool pass = !_hasSent || sample.convStep != _sentConvStep; 
+
+  if (!pass) {
+    uint32_t change = (milliLux > _sentMilliLux) ? milliLux - _sentMilliLux : _sentMilliLux - milliLux; 
+    uint32_t band = ((uint64_t)_sentMilliLux * _relPerMille) / 1000; 
+    if (band < _absMilliLux)
+      band = _absMilliLux; 
+    pass = (change > band) ||
+           (_maxSilenceMs && (uint32_t)(sample.timestamp - _sentAt) >= _maxSilenceMs); 
+  }
+
+  if (pass) {
+    _hasSent = true; 
+    _sentConvStep = sample.convStep; 
+    _sentMilliLux = milliLux; 
+    _sentAt = sample.timestamp; 
+  }
+  return pass; 
+
+}
+
+// This function reads the sensor's raw count (one bus transaction) and
+// checks it. The sample is stored in last() either way, unless the read or
+// the conversion step failed. 
+bool VEML6030ChangeFilter::update(SparkFun_Ambient_Light_A &sensor, uint32_t now){
+
+  uint16_t raw; 
+  if (sensor.readLightRaw(raw) != VEML6030_OK)
+    return false; 
+  uint8_t convStep = sensor.readConvStep(); 
+  if (convStep == VEML6030::CONV_STEP_INVALID)
+    return false; 
+
+  _last.timestamp = now; 
+  _last.raw = raw; 
+  _last.convStep = convStep; 
+  return accept(_last); 
+
+}
+
+VEML6030StreamEncoder::VEML6030StreamEncoder(uint8_t *buffer, uint16_t capacity)
+{
+
+  _buffer = buffer; 
+  _capacity = capacity; 
+  reset(); 
+
+}
+
+// This function starts a new, empty block. 
+void VEML6030StreamEncoder::reset(){
+
+  _size = 0; 
+  _count = 0; 
+
+}
+
+// This function adds a sample to the block. 
+bool VEML6030StreamEncoder::add(const VEML6030RawSample &sample){
+
+  uint8_t bytes[MAX_SAMPLE + 1]; 
+  uint8_t length = 0; 
+
+  // The decoder rejects such a block, so it is never started.
+  if (sample.convStep > 9)
+    return false; 
+
+  if (_count == 0) {
+    bytes[length++] = sample.convStep; 
+    length += _put(&bytes[length], sample.timestamp); 
+    length += _put(&bytes[length], sample.raw); 
+  }
+  else {
+    if (sample.convStep != _buffer[0])
+      return false; 
+    // Zig-zag: small differences of either sign become small numbers.
+    int32_t delta = (int32_t)sample.raw - _lastRaw; 
+    length += _put(&bytes[length], ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)); 
+    length += _put(&bytes[length], sample.timestamp - _lastTimestamp); 
+  }
+
+  if (_size + length > _capacity)
+    return false; 
+
+  for (uint8_t i = 0; i < length; i++)
+    _buffer[_size++] = bytes[i]; 
+  _count++; 
+  _lastRaw = sample.raw; 
+  _lastTimestamp = sample.timestamp; 
+  return true; 
+
+}
+
+// This function writes a varint and returns its length. 
+uint8_t VEML6030StreamEncoder::_put(uint8_t *_out, uint32_t _value){
+
+  uint8_t _length = 0; 
+  while (_value >= 0x80) {
+    _out[_length++] = (_value & 0x7F) | 0x80; 
+    _value >>= 7; 
+  }
+  _out[_length++] = _value; 
+  return _length; 
+
+}
+
+VEML6030StreamDecoder::VEML6030StreamDecoder(const uint8_t *data, uint16_t size)
+{
+
+  _data = data; 
+  _size = size; 
+  _pos = 0; 
+  _error = false; 
+  _started = false; 
+
+}
+
+// This function returns the next sample. 
+bool VEML6030StreamDecoder::next(VEML6030RawSample &sample){
+
+  if (_error || _pos >= _size)
+    return false; 
+
+  uint32_t first, second; 
+
+  if (!_started) {
+    _convStep = _data[_pos++]; 
+    if (_convStep > 9 || !_get(first) || !_get(second) || second > 0xFFFF) {
+      _error = true; 
+      return false; 
+    }
+    _lastTimestamp = first; 
+    _lastRaw = second; 
+    _started = true; 
+  }
+  else {
+    if (!_get(first) || !_get(second)) {
+      _error = true; 
+      return false; 
+    }
+    int32_t raw = (int32_t)_lastRaw + (int32_t)((first >> 1) ^ (0 - (first & 1))); 
+    if (raw < 0 || raw > 0xFFFF) {
+      _error = true; 
+      return false; 
+    }
+    _lastRaw = raw; 
+    _lastTimestamp += second; 
+  }
+
+  sample.timestamp = _lastTimestamp; 
+  sample.raw = _lastRaw; 
+  sample.convStep = _convStep; 
+  return true; 
+
+}
+
+// This function reads a varint. Returns false if the block ends inside it or it
+// is longer than 32 bits. 
+bool VEML6030StreamDecoder::_get(uint32_t &_value){
+
+  _value = 0; 
+  for (uint8_t _shift = 0; _shift < 35; _shift += 7) {
+    if (_pos >= _size)
+      return false; 
+    uint8_t _byte = _data[_pos++]; 
+    if (_shift == 28 && _byte > 0x0F) // Only 4 bits are left, and no more bytes.
+      return false; 
+    _value |= (uint32_t)(_byte & 0x7F) << _shift; 
+    if (!(_byte & 0x80))
+      return true; 
+  }
+  return false; 
+
+}
@@ -0,0 +1,131 @@
+#ifndef _SPARKFUN_VEML6030_STREAM_H_
+#define _SPARKFUN_VEML6030_STREAM_H_
+
+#include "SparkFun_VEML6030_Ambient_Light_Sensor_A.h"
+#include "SparkFun_VEML6030_SampleBuffer.h"
+
+// Decides which samples are worth sending. A sample passes if it is the
+// first one, if the conversion step changed, if it differs from the last
+// sample that passed by more than the deadband, or if nothing has passed for
+// the maximum silence interval. The deadband is the larger of an absolute
+// value in milli-lux and a share of the last value in parts per thousand, so
+// it can follow both dim and bright light. Values are compared in milli-lux,
+// compensation included.
+class VEML6030ChangeFilter
+{
+  public:
+
+    VEML6030ChangeFilter(uint32_t absMilliLux = 0, uint16_t relPerMille = 0,
+                         uint32_t maxSilenceMs = 0);
+
+    // These functions change the deadband and the maximum silence interval
+    // (0 for none). 
+    void setDeadband(uint32_t absMilliLux, uint16_t relPerMille);
+    void setMaxSilence(uint32_t maxSilenceMs);
+
+    // This function checks a sample and returns true if it passes. 
+    bool accept(const VEML6030RawSample &sample);
+
+    // This function reads the sensor's raw count (one bus transaction) and
+    // checks it. The sample is stored in last() either way, unless the read or
+    // the conversion step failed. 
+    bool update(SparkFun_Ambient_Light_A &sensor, uint32_t now);
+
+    // This function returns the last sample given to update(). 
+    const VEML6030RawSample &last(){ return _last; }
+
+    // This function forgets the last sample that passed, so the next one
+    // passes. 
+    void reset(){ _hasSent = false; }
+
+  private:
+
+    uint32_t _absMilliLux;
+    uint16_t _relPerMille;
+    uint32_t _maxSilenceMs;
+
+    bool _hasSent;
+    uint8_t _sentConvStep;
+    uint32_t _sentMilliLux;
+    uint32_t _sentAt;
+    VEML6030RawSample _last;
+};
+
+// Packs samples into blocks for a link where every byte counts. A block is
+//
+//   conversion step    1 byte, 0 - 9, the same for every sample in the block
+//   first timestamp    varint
+//   first raw count    varint
+//   then per sample    zig-zag varint of the count difference to the sample
+//                      before, varint of the time difference
+//
+// where a varint stores 7 bits per byte, low bits first, with the top bit set
+// on every byte but the last. The conversion step stands for the gain and
+// integration time: every pair with the same step converts the same way. A
+// block has no length or count field, so the link has to frame it, e.g. one
+// block per packet. A steady sample then costs two bytes.
+class VEML6030StreamEncoder
+{
+  public:
+
+    // The encoder writes into the given buffer, which has to hold at least
+    // MAX_HEADER bytes.
+    VEML6030StreamEncoder(uint8_t *buffer, uint16_t capacity);
+
+    static const uint8_t MAX_HEADER = 1 + 5 + 3;
+    static const uint8_t MAX_SAMPLE = 3 + 5;
+
+    // This function adds a sample to the block. It returns false, leaving the
+    // block as it is, if the sample does not fit or has a different conversion
+    // step. Send the block, reset() and add the sample again. A sample with no
+    // valid conversion step (above 9) is never added. 
+    bool add(const VEML6030RawSample &sample);
+
+    // This function starts a new, empty block. 
+    void reset();
+
+    // These functions return the block built so far. 
+    const uint8_t *data(){ return _buffer; }
+    uint16_t size(){ return _size; }
+    uint16_t count(){ return _count; }
+
+  private:
+
+    uint8_t _put(uint8_t *_out, uint32_t _value);
+
+    uint8_t *_buffer;
+    uint16_t _capacity;
+    uint16_t _size;
+    uint16_t _count;
+    uint16_t _lastRaw;
+    uint32_t _lastTimestamp;
+};
+
+// Unpacks a block written by VEML6030StreamEncoder. 
+class VEML6030StreamDecoder
+{
+  public:
+
+    VEML6030StreamDecoder(const uint8_t *data, uint16_t size);
+
+    // This function returns the next sample. It returns false at the end of
+    // the block, or if the block is malformed, in which case error() is set. 
+    bool next(VEML6030RawSample &sample);
+
+    // This function returns true if the block was found to be malformed. 
+    bool error(){ return _error; }
+
+  private:
+
+    bool _get(uint32_t &_value);
+
+    const uint8_t *_data;
+    uint16_t _size;
+    uint16_t _pos;
+    bool _error;
+    bool _started;
+    uint8_t _convStep;
+    uint16_t _lastRaw;
+    uint32_t _lastTimestamp;
+};
+#endif